@@ -0,0 +1,213 @@
+#include "analysis.hpp"
+#include "instrumentation.hpp"
+
+using namespace std;
+
+BlockingAnalysis::BlockingAnalysis(const vector<Job> &jobs, const vector<Resource> &resources, int choice)
+    : jobs_(jobs), resources_(resources), choice_(choice)
+{
+    for (auto &job : jobs_)
+    {
+        job.sections = flattenCriticalSections(job);
+    }
+    assignPreemptionLevels(jobs_);
+}
+
+BlockingAnalysis::BlockingAnalysis(const Inheritance &inheritance)
+    : jobs_(inheritance.getJobTemplates()), resources_(inheritance.getResources()), choice_(inheritance.getChoice()) {}
+
+// Priority the ceilings are expressed in: the base priority, or the preemption level under SRP
+int BlockingAnalysis::levelOf(const Job &job) const
+{
+    if (choice_ != CHOICE_SRP)
+        return job.basePriority;
+    for (const auto &other : jobs_)
+    {
+        if (other.id == job.id)
+            return other.preemptionLevel;
+    }
+    return job.preemptionLevel;
+}
+
+// Longest critical section of the job, nested ones included, on any resource whose ceiling is at least minCeiling
+int BlockingAnalysis::longestCriticalSection(const Job &job, int minCeiling) const
+{
+    int longest = 0;
+    for (const auto &section : job.sections)
+    {
+        for (const auto &resource : resources_)
+        {
+            if (resource.id == section.resourceId && resource.ceilingPriority >= minCeiling)
+                longest = max(longest, section.end - section.start);
+        }
+    }
+    return longest;
+}
+
+// Longest critical section of the job on the given resource
+int BlockingAnalysis::longestCriticalSection(const Job &job, const Resource &resource) const
+{
+    int longest = 0;
+    for (const auto &section : job.sections)
+    {
+        if (section.resourceId == resource.id)
+            longest = max(longest, section.end - section.start);
+    }
+    return longest;
+}
+
+int BlockingAnalysis::computeBlockingTime(const Job &job) const
+{
+    if (choice_ == CHOICE_PIP)
+    {
+        // A job can be blocked at most once by every lower priority job and at most once on
+        // every resource, so B is the smaller of the two sums
+        int byJobs = 0;
+        for (const auto &other : jobs_)
+        {
+            if (other.basePriority < job.basePriority)
+                byJobs += longestCriticalSection(other, job.basePriority);
+        }
+
+        int byResources = 0;
+        for (const auto &resource : resources_)
+        {
+            if (resource.ceilingPriority < job.basePriority)
+                continue;
+            int longest = 0;
+            for (const auto &other : jobs_)
+            {
+                if (other.basePriority < job.basePriority)
+                    longest = max(longest, longestCriticalSection(other, resource));
+            }
+            byResources += longest;
+        }
+        return min(byJobs, byResources);
+    }
+
+    // OCPP, ICPP and SRP: blocked for at most one critical section of a lower priority job
+    // on a resource whose ceiling is at least our priority
+    int level = levelOf(job);
+    int blocking = 0;
+    for (const auto &other : jobs_)
+    {
+        if (levelOf(other) < level)
+            blocking = max(blocking, longestCriticalSection(other, level));
+    }
+    return blocking;
+}
+
+// Response time measured from release; returns as soon as it exceeds the relative deadline
+int BlockingAnalysis::computeResponseTime(const Job &job) const
+{
+    if (choice_ == CHOICE_SRP)
+        throw runtime_error("Response time analysis needs fixed priorities; use the SRP demand test");
+    int deadline = job.deadline - job.releaseTime;
+    int base = job.WCET + computeBlockingTime(job);
+    int previousTime = 0;
+    int responseTime = base;
+    long long iterations = 0;
+    while (responseTime != previousTime && responseTime <= deadline)
+    {
+        ++iterations;
+        previousTime = responseTime;
+        responseTime = base;
+        for (const auto &other : jobs_)
+        {
+            if (other.basePriority > job.basePriority)
+                responseTime += static_cast<int>(ceil(static_cast<double>(previousTime) / other.period)) * other.WCET;
+        }
+    }
+    INSTRUMENT_TASK_ITERATIONS(job.id, iterations);
+    return responseTime;
+}
+
+bool BlockingAnalysis::runRTATest() const
+{
+    INSTRUMENT_PHASE(PHASE_ANALYZE);
+    if (choice_ == CHOICE_SRP)
+        throw runtime_error("Response time analysis needs fixed priorities; use the SRP demand test");
+    cout << "\nRunning response time analysis with blocking...\n";
+    bool schedulable = true;
+    for (const auto &job : jobs_)
+    {
+        int blocking = computeBlockingTime(job);
+        int responseTime = computeResponseTime(job);
+        int deadline = job.deadline - job.releaseTime;
+        cout << "Task " << job.id << " blocking time: " << blocking << ", response time: " << responseTime;
+        if (responseTime > deadline)
+        {
+            cout << " > " << deadline << ", not schedulable\n";
+            schedulable = false;
+        }
+        else
+        {
+            cout << " <= " << deadline << ", schedulable\n";
+        }
+    }
+    return schedulable;
+}
+
+// Baker's demand criterion: for every absolute deadline L up to H + max D,
+// sum of floor((L - D_i) / T_i + 1) * C_i over jobs with D_i <= L, plus B(L), must not exceed L.
+// B(L) is the longest critical section of a job with D > L on a resource whose ceiling
+// can block some job with D <= L.
+bool BlockingAnalysis::runSRPDemandTest() const
+{
+    INSTRUMENT_PHASE(PHASE_ANALYZE);
+    cout << "\nRunning EDF processor demand test with SRP blocking...\n";
+    double utilization = 0.0;
+    UtilizationSum exact;
+    int hyper = 1;
+    int maxDeadline = 0;
+    for (const auto &job : jobs_)
+    {
+        utilization += static_cast<double>(job.WCET) / job.period;
+        exact.add(job.WCET, job.period);
+        hyper = lcm(hyper, job.period);
+        maxDeadline = max(maxDeadline, relativeDeadline(job));
+    }
+    if (exact.exceedsOne())
+    {
+        cout << "Unschedulable: " << utilization << " > 1\n";
+        return false;
+    }
+
+    vector<int> L;
+    for (const auto &job : jobs_)
+    {
+        for (int d = relativeDeadline(job); d <= hyper + maxDeadline; d += job.period)
+            L.push_back(d);
+    }
+    sort(L.begin(), L.end());
+    L.erase(unique(L.begin(), L.end()), L.end());
+
+    for (const auto &l : L)
+    {
+        INSTRUMENT_COUNT(COUNTER_PDC_POINTS, 1);
+        int demand = 0;
+        int minLevel = INT_MAX;
+        for (const auto &job : jobs_)
+        {
+            if (relativeDeadline(job) <= l)
+            {
+                demand += ((l - relativeDeadline(job)) / job.period + 1) * job.WCET;
+                minLevel = min(minLevel, job.preemptionLevel);
+            }
+        }
+        int blocking = 0;
+        for (const auto &job : jobs_)
+        {
+            if (relativeDeadline(job) > l)
+                blocking = max(blocking, longestCriticalSection(job, minLevel));
+        }
+
+        if (demand + blocking > l)
+        {
+            cout << "Unschedulable at time " << l << ": " << demand << " + " << blocking << " > " << l << "\n";
+            return false;
+        }
+        cout << "Schedulable at time " << l << ": " << demand << " + " << blocking << " <= " << l << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+// Worst-case blocking analysis for the resource sharing protocols.
+// The blocking term B_i of every job is derived from its critical-section lengths and
+// the resource ceilings computed by Inheritance, and then fed into response time analysis:
+// R_i = C_i + B_i + sum over higher priority jobs of ceil(R_i / T_j) * C_j
+// For EDF with SRP it is fed into the processor demand criterion instead.
+#ifndef ANALYSIS_HPP
+#define ANALYSIS_HPP
+#include "scheduler.hpp"
+
+class BlockingAnalysis
+{
+public:
+    BlockingAnalysis(const vector<Job> &jobs, const vector<Resource> &resources, int choice = CHOICE);
+    BlockingAnalysis(const Inheritance &inheritance);
+
+    int computeBlockingTime(const Job &job) const;
+    // Fixed-priority response time analysis over the base priorities. Under SRP the jobs are
+    // scheduled by EDF, so both throw runtime_error; use runSRPDemandTest instead.
+    int computeResponseTime(const Job &job) const;
+    bool runRTATest() const;
+    bool runSRPDemandTest() const;
+
+private:
+    int levelOf(const Job &job) const;
+    int longestCriticalSection(const Job &job, int minCeiling) const;
+    int longestCriticalSection(const Job &job, const Resource &resource) const;
+
+    vector<Job> jobs_;
+    vector<Resource> resources_;
+    int choice_;
+};
+
+#endif // ANALYSIS_HPP
@@ -0,0 +1,369 @@
+#include "cli.hpp"
+#include "analysis.hpp"
+#include "task_file.hpp"
+#include "timeline_query.hpp"
+#include "comparison.hpp"
+#include "instrumentation.hpp"
+#include <fstream>
+#include <sstream>
+
+static const map<string, int> algorithms = {
+    {"rm", CHOICE_RM}, {"dm", CHOICE_DM}, {"edf", CHOICE_EDF}, {"lst", CHOICE_LST}, {"arb", CHOICE_ARB_DEADLINE},
+    {"pip", CHOICE_PIP}, {"ocpp", CHOICE_OCPP}, {"icpp", CHOICE_ICPP}, {"srp", CHOICE_SRP}};
+
+struct CommandLine
+{
+    string algorithm;
+    int choice = CHOICE;
+    vector<string> compare; // policies to compare instead of running one algorithm
+    string taskFile = "-";
+    int format = -1; // from the file extension unless given
+    int resources = 0;
+    long long horizon = 0;
+    int missPolicy = MISS_CONTINUE;
+    bool stopAtMiss = false;
+    int threads = 1;
+    long long quantum = 1;
+    bool timeline = true;
+    bool log = false;
+    string renderPrefix;
+    string traceFile;
+    string instrumentationFile; // counters and phase timers, when built with SCHEDULER_INSTRUMENTATION
+};
+
+// Discards everything written to it
+class NullBuffer : public streambuf
+{
+protected:
+    int overflow(int c) override
+    {
+        return c;
+    }
+};
+
+static void printUsage(ostream &out)
+{
+    out << "usage: scheduler --algorithm rm|dm|edf|lst|arb|pip|ocpp|icpp|srp [--tasks FILE] [--format csv|jsonl]\n"
+           "                 [--resources N] [--horizon H] [--miss-policy continue|abort|skip] [--stop-at-miss]\n"
+           "                 [--threads N] [--quantum Q] [--no-timeline] [--render PREFIX] [--trace FILE] [--log]\n"
+           "                 [--instrumentation FILE]\n"
+           "       scheduler --compare rm,dm,edf,lst [--tasks FILE] [--format csv|jsonl] [--horizon H] [--threads N]\n"
+           "                 [--no-timeline] [--instrumentation FILE]\n"
+           "Without arguments the scheduler asks for the task set interactively.\n";
+}
+
+static CommandLine parseArguments(int argc, char **argv)
+{
+    CommandLine command;
+    for (int i = 1; i < argc; ++i)
+    {
+        string flag = argv[i];
+        auto value = [&]() -> string {
+            if (i + 1 >= argc)
+                throw runtime_error(flag + " needs a value");
+            return argv[++i];
+        };
+        if (flag == "--algorithm" || flag == "-a")
+        {
+            command.algorithm = value();
+            auto it = algorithms.find(command.algorithm);
+            if (it == algorithms.end())
+                throw runtime_error("unknown algorithm " + command.algorithm);
+            command.choice = it->second;
+        }
+        else if (flag == "--compare")
+        {
+            stringstream list(value());
+            string name;
+            while (getline(list, name, ','))
+            {
+                if (name != "rm" && name != "dm" && name != "edf" && name != "lst")
+                    throw runtime_error("cannot compare algorithm " + name);
+                command.compare.push_back(name);
+            }
+        }
+        else if (flag == "--tasks" || flag == "-t")
+            command.taskFile = value();
+        else if (flag == "--format")
+        {
+            string format = value();
+            if (format != "csv" && format != "jsonl")
+                throw runtime_error("unknown format " + format);
+            command.format = format == "csv" ? TASK_FORMAT_CSV : TASK_FORMAT_JSONL;
+        }
+        else if (flag == "--resources")
+            command.resources = stoi(value());
+        else if (flag == "--horizon")
+            command.horizon = stoll(value());
+        else if (flag == "--miss-policy")
+        {
+            string policy = value();
+            if (policy == "continue")
+                command.missPolicy = MISS_CONTINUE;
+            else if (policy == "abort")
+                command.missPolicy = MISS_ABORT;
+            else if (policy == "skip")
+                command.missPolicy = MISS_SKIP_NEXT;
+            else
+                throw runtime_error("unknown miss policy " + policy);
+        }
+        else if (flag == "--stop-at-miss")
+            command.stopAtMiss = true;
+        else if (flag == "--threads")
+            command.threads = stoi(value());
+        else if (flag == "--quantum")
+            command.quantum = stoll(value());
+        else if (flag == "--no-timeline")
+            command.timeline = false;
+        else if (flag == "--render")
+            command.renderPrefix = value();
+        else if (flag == "--trace")
+            command.traceFile = value();
+        else if (flag == "--log")
+            command.log = true;
+        else if (flag == "--instrumentation")
+            command.instrumentationFile = value();
+        else
+            throw runtime_error("unknown argument " + flag);
+    }
+    if (command.choice == CHOICE && command.compare.empty())
+        throw runtime_error("--algorithm or --compare is required");
+    if (command.horizon < 0)
+        throw runtime_error("invalid horizon");
+    if (command.format < 0)
+    {
+        const string &file = command.taskFile;
+        auto endsWith = [&](const string &suffix) {
+            return file.size() >= suffix.size() && file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        command.format = endsWith(".json") || endsWith(".jsonl") ? TASK_FORMAT_JSONL : TASK_FORMAT_CSV;
+    }
+    return command;
+}
+
+static bool usesResources(int choice)
+{
+    return choice == CHOICE_PIP || choice == CHOICE_OCPP || choice == CHOICE_ICPP || choice == CHOICE_SRP;
+}
+
+static void writeTimeline(ostream &out, const vector<TimelineInterval> &timeline)
+{
+    // [task, start, length] triples, task -1 being idle
+    out << ",\"timeline\":[";
+    for (size_t i = 0; i < timeline.size(); ++i)
+        out << (i ? "," : "") << "[" << timeline[i].taskId << "," << timeline[i].start << "," << timeline[i].length << "]";
+    out << "]";
+}
+
+// Observed response times and preemptions of one task, then the fields the caller adds
+static void writeObserved(ostream &out, const TimelineQuery &query, int taskId)
+{
+    vector<long long> responses = query.responseTimes(taskId);
+    out << ",\"jobsCompleted\":" << responses.size();
+    if (!responses.empty())
+        out << ",\"worstObservedResponse\":" << *max_element(responses.begin(), responses.end());
+    out << ",\"preemptions\":" << query.preemptionCount(taskId);
+}
+
+static void writeSummary(ostream &out, const TimelineQuery &query, bool withTimeline, const vector<TimelineInterval> &timeline)
+{
+    out << ",\"horizon\":" << query.getHorizon()
+        << ",\"preemptions\":" << query.preemptionCount()
+        << ",\"contextSwitches\":" << query.contextSwitchCount();
+    if (withTimeline)
+        writeTimeline(out, timeline);
+}
+
+static bool runScheduler(const CommandLine &command, istream &in, ostream &out)
+{
+    Scheduler scheduler(readTasks(in, command.format), command.choice);
+    if (scheduler.tasks_.empty())
+        throw runtime_error("no tasks given");
+
+    bool schedulable = false;
+    if (command.choice == CHOICE_RM || command.choice == CHOICE_DM)
+        schedulable = scheduler.runRMDMTest(scheduler.tasks_);
+    else if (command.choice == CHOICE_EDF || command.choice == CHOICE_LST)
+        schedulable = scheduler.runEDFLSTTest();
+    else
+        schedulable = scheduler.runOPA();
+    // like the interactive mode, an unschedulable set is not simulated
+    scheduler.setMissPolicy(command.missPolicy, command.stopAtMiss);
+    scheduler.setThreadCount(command.threads);
+    scheduler.setMinimumQuantum(command.quantum);
+    if (schedulable)
+        scheduler.generateTimeline(command.horizon);
+
+    TimelineQuery query(scheduler);
+    out << "{\"algorithm\":\"" << command.algorithm << "\",\"schedulable\":" << (schedulable ? "true" : "false")
+        << ",\"utilization\":" << scheduler.computeUtilization() << ",\"tasks\":[";
+    for (size_t i = 0; i < scheduler.tasks_.size(); ++i)
+    {
+        const Task &task = scheduler.tasks_[i];
+        out << (i ? "," : "") << "{\"id\":" << task.id << ",\"priority\":" << task.priority;
+        writeObserved(out, query, task.id);
+        if (i < scheduler.getResponseStatistics().size())
+        {
+            const ResponseStatistics &stats = scheduler.getResponseStatistics()[i];
+            out << ",\"meanResponse\":" << stats.mean() << ",\"p99Response\":" << stats.percentile(0.99)
+                << ",\"startJitter\":" << stats.startJitter();
+        }
+        long long bound = scheduler.computeResponseBound(task);
+        if (bound >= 0 && bound != LLONG_MAX)
+            out << ",\"responseBound\":" << bound;
+        out << "}";
+    }
+    out << "]";
+    // [task, release, deadline, completion] per missed job, completion -1 if it never completed
+    out << ",\"deadlineMisses\":[";
+    const vector<DeadlineMiss> &misses = scheduler.getDeadlineMisses();
+    for (size_t i = 0; i < misses.size(); ++i)
+        out << (i ? "," : "") << "[" << misses[i].taskId << "," << misses[i].release << "," << misses[i].deadline << ","
+            << misses[i].completion << "]";
+    out << "]";
+    writeSummary(out, query, command.timeline, scheduler.timeline);
+    out << "}\n";
+
+    if (!command.renderPrefix.empty())
+        scheduler.renderTimeline(command.renderPrefix);
+    // the trace streams from a simulation of its own rather than from the timeline kept above,
+    // so like that timeline it is only written for a schedulable set
+    if (!command.traceFile.empty() && schedulable && !scheduler.exportTrace(command.traceFile, command.horizon))
+        throw runtime_error("cannot write " + command.traceFile);
+    return schedulable;
+}
+
+static bool runInheritance(const CommandLine &command, istream &in, ostream &out)
+{
+    vector<Job> jobs = readJobs(in, command.format);
+    if (jobs.empty())
+        throw runtime_error("no tasks given");
+    int resources = command.resources > 0 ? command.resources : max(1, countResources(jobs));
+    // the resource simulator keeps time in an int
+    if (command.horizon > INT_MAX)
+        throw runtime_error("horizon " + to_string(command.horizon) + " is too long for " + command.algorithm);
+    Inheritance inheritance(jobs, resources, command.choice, static_cast<int>(command.horizon));
+    BlockingAnalysis analysis(inheritance);
+    bool schedulable = command.choice == CHOICE_SRP ? analysis.runSRPDemandTest() : analysis.runRTATest();
+    inheritance.simulateResource();
+
+    TimelineQuery query(inheritance);
+
+    out << "{\"algorithm\":\"" << command.algorithm << "\",\"schedulable\":" << (schedulable ? "true" : "false")
+        << ",\"allJobsFinished\":" << (inheritance.allTasksFinished() ? "true" : "false") << ",\"tasks\":[";
+    const vector<Job> &templates = inheritance.getJobTemplates();
+    for (size_t i = 0; i < templates.size(); ++i)
+    {
+        const Job &job = templates[i];
+        out << (i ? "," : "") << "{\"id\":" << job.id << ",\"priority\":" << job.basePriority
+            << ",\"blocking\":" << analysis.computeBlockingTime(job);
+        if (command.choice != CHOICE_SRP)
+            out << ",\"responseBound\":" << analysis.computeResponseTime(job);
+        writeObserved(out, query, job.id);
+        out << "}";
+    }
+    out << "]";
+    if (command.choice == CHOICE_SRP)
+        out << ",\"peakStackUsage\":" << inheritance.getPeakStackUsage();
+    writeSummary(out, query, command.timeline, query.getIntervals());
+    out << "}\n";
+
+    if (!command.renderPrefix.empty())
+        inheritance.renderTimeline(command.renderPrefix);
+    if (!command.traceFile.empty() && !inheritance.exportTrace(command.traceFile))
+        throw runtime_error("cannot write " + command.traceFile);
+    return schedulable;
+}
+
+// Returns true when no policy missed a deadline
+static bool runComparison(const CommandLine &command, istream &in, ostream &out)
+{
+    vector<int> choices;
+    for (const string &name : command.compare)
+        choices.push_back(algorithms.at(name));
+    PolicyComparison comparison(readTasks(in, command.format), choices);
+    comparison.run(command.horizon, command.threads > 1);
+
+    bool met = true;
+    out << "{\"policies\":[";
+    const vector<PolicyReport> &reports = comparison.getReports();
+    for (size_t k = 0; k < reports.size(); ++k)
+    {
+        const PolicyReport &report = reports[k];
+        met = met && report.misses.empty();
+        out << (k ? "," : "") << "{\"algorithm\":\"" << command.compare[k] << "\",\"deadlineMisses\":" << report.misses.size()
+            << ",\"preemptions\":" << report.preemptions << ",\"worstResponse\":{";
+        for (size_t i = 0; i < comparison.getTasks().size(); ++i)
+            out << (i ? "," : "") << "\"" << comparison.getTasks()[i].id << "\":" << report.responses[i].maximum;
+        out << "}";
+        if (command.timeline)
+            writeTimeline(out, report.timeline);
+        out << "}";
+    }
+    out << "]}\n";
+    return met;
+}
+
+int runCommandLine(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (string(argv[i]) == "--help" || string(argv[i]) == "-h")
+        {
+            printUsage(cout);
+            return 0;
+        }
+    }
+
+    // the analyses and simulators narrate to cout; keep stdout for the JSON result
+    NullBuffer discard;
+    ostream out(cout.rdbuf());
+    streambuf *saved = cout.rdbuf();
+    CommandLine command;
+    try
+    {
+        command = parseArguments(argc, argv);
+    }
+    catch (const exception &error)
+    {
+        cerr << "scheduler: " << error.what() << "\n";
+        printUsage(cerr);
+        return 2;
+    }
+
+    int status = 2;
+    try
+    {
+        ifstream file;
+        if (command.taskFile != "-")
+        {
+            file.open(command.taskFile);
+            if (!file)
+                throw runtime_error("cannot open " + command.taskFile);
+        }
+        istream &in = command.taskFile == "-" ? cin : file;
+
+        cout.rdbuf(command.log ? cerr.rdbuf() : &discard);
+        bool schedulable;
+        if (!command.compare.empty())
+            schedulable = runComparison(command, in, out);
+        else
+            schedulable = usesResources(command.choice) ? runInheritance(command, in, out) : runScheduler(command, in, out);
+        status = schedulable ? 0 : 1;
+        if (!command.instrumentationFile.empty())
+        {
+            ofstream instrumentation(command.instrumentationFile);
+            writeInstrumentation(instrumentation);
+            if (!instrumentation)
+                throw runtime_error("cannot write " + command.instrumentationFile);
+        }
+    }
+    catch (const exception &error)
+    {
+        cout.rdbuf(saved);
+        cerr << "scheduler: " << error.what() << "\n";
+        return 2;
+    }
+    cout.rdbuf(saved);
+    return status;
+}
@@ -0,0 +1,21 @@
+// Non-interactive mode of the scheduler binary:
+//
+//   scheduler --algorithm rm|dm|edf|lst|arb|pip|ocpp|icpp|srp [--tasks FILE] [--format csv|jsonl]
+//             [--resources N] [--horizon H] [--miss-policy continue|abort|skip] [--stop-at-miss]
+//             [--threads N] [--quantum Q] [--no-timeline] [--render PREFIX] [--trace FILE] [--log]
+//             [--instrumentation FILE]
+//   scheduler --compare rm,dm,edf,lst [--tasks FILE] [--format csv|jsonl] [--horizon H] [--threads N]
+//             [--no-timeline] [--instrumentation FILE]
+//
+// Tasks are read from FILE, or stdin when it is omitted or "-", in the formats described in
+// task_file.hpp. The verdict, per-task results and the timeline are written to stdout as one
+// JSON object. Nothing is rendered unless --render is given, and the analysis logs go to
+// stderr with --log and are dropped otherwise.
+#ifndef CLI_HPP
+#define CLI_HPP
+#include "scheduler.hpp"
+
+// Returns the process exit code: 0 when schedulable, 1 when not, 2 on bad input
+int runCommandLine(int argc, char **argv);
+
+#endif // CLI_HPP
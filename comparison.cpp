@@ -0,0 +1,131 @@
+#include "comparison.hpp"
+#include "timeline_sink.hpp"
+#include "instrumentation.hpp"
+#include <thread>
+
+// ticks whose releases are worked out at once
+static const long long releaseWindow = 1 << 16;
+
+string policyName(int choice)
+{
+    switch (choice)
+    {
+    case CHOICE_RM:
+        return "RM";
+    case CHOICE_DM:
+        return "DM";
+    case CHOICE_EDF:
+        return "EDF";
+    case CHOICE_LST:
+        return "LST";
+    }
+    throw runtime_error("Cannot compare policy " + to_string(choice));
+}
+
+PolicyComparison::PolicyComparison(const vector<Task> &tasks, const vector<int> &choices)
+    : tasks(tasks)
+{
+    if (tasks.empty())
+        throw runtime_error("No tasks to compare");
+    for (const auto &task : tasks)
+    {
+        // releases are generated period by period
+        if (task.period <= 0 || task.WCET <= 0)
+            throw runtime_error("Task " + to_string(task.id) + " needs a positive WCET and period");
+    }
+    for (int choice : choices)
+    {
+        policyName(choice); // rejects the others
+        schedulers.emplace_back(tasks, choice);
+        if (choice == CHOICE_RM || choice == CHOICE_DM)
+            schedulers.back().setPriority();
+    }
+}
+
+void PolicyComparison::run(long long horizon, bool parallel)
+{
+    INSTRUMENT_PHASE(PHASE_SIMULATE);
+    if (horizon == 0)
+        horizon = schedulers.empty() ? 0 : schedulers[0].computeHyperperiod();
+    const size_t policies = schedulers.size();
+    vector<SimulationState> states;
+    for (const auto &scheduler : schedulers)
+        states.push_back(scheduler.startSimulation());
+    vector<MemorySink> sinks(policies);
+
+    vector<long long> nextRelease(tasks.size(), 0);
+    vector<ReleaseEvent> releases;
+    for (long long begin = 0; begin < horizon; begin += releaseWindow)
+    {
+        const long long end = min(horizon, begin + releaseWindow);
+        releases.clear();
+        for (size_t i = 0; i < tasks.size(); ++i)
+            for (; nextRelease[i] < end; nextRelease[i] += tasks[i].period)
+                releases.push_back({nextRelease[i], static_cast<int>(i)});
+        sort(releases.begin(), releases.end(), [](const ReleaseEvent &a, const ReleaseEvent &b) {
+            return a.time != b.time ? a.time < b.time : a.task < b.task;
+        });
+
+        auto step = [&](size_t k) {
+            states[k].releases = &releases;
+            states[k].releaseCursor = 0;
+            schedulers[k].advance(states[k], end, sinks[k]);
+        };
+        if (parallel)
+        {
+            vector<thread> workers;
+            for (size_t k = 1; k < policies; ++k)
+                workers.emplace_back(step, k);
+            if (policies > 0)
+                step(0);
+            for (auto &worker : workers)
+                worker.join();
+        }
+        else
+        {
+            for (size_t k = 0; k < policies; ++k)
+                step(k);
+        }
+    }
+
+    reports.clear();
+    for (size_t k = 0; k < policies; ++k)
+    {
+        states[k].releases = nullptr;
+        schedulers[k].finishSimulation(states[k], sinks[k]);
+        PolicyReport report;
+        report.choice = schedulers[k].choice_;
+        report.timeline = sinks[k].getIntervals();
+        report.misses = states[k].misses;
+        report.preemptions = states[k].preemptions;
+        report.responses = states[k].responses;
+        reports.push_back(report);
+    }
+}
+
+const vector<Task> &PolicyComparison::getTasks() const
+{
+    return tasks;
+}
+
+const vector<PolicyReport> &PolicyComparison::getReports() const
+{
+    return reports;
+}
+
+void PolicyComparison::writeReport(ostream &out) const
+{
+    out << left << setw(8) << "Policy" << setw(8) << "Misses" << setw(13) << "Preemptions" << "Worst response";
+    for (const auto &task : tasks)
+        out << " T" << task.id;
+    out << "\n";
+    for (const auto &report : reports)
+    {
+        out << left << setw(8) << policyName(report.choice) << setw(8) << report.misses.size() << setw(13)
+            << report.preemptions << setw(14) << "";
+        for (size_t i = 0; i < tasks.size(); ++i)
+            out << " " << report.responses[i].maximum;
+        out << "\n";
+    }
+    out << right;
+}
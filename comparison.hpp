@@ -0,0 +1,40 @@
+// Runs several scheduling policies over one task set in a single pass. Releases are worked out
+// once per window of time and shared by the simulation of every policy; the simulations advance
+// window by window in lockstep, each on a thread of its own if asked to.
+#ifndef COMPARISON_HPP
+#define COMPARISON_HPP
+#include "scheduler.hpp"
+
+// What one policy did over the compared horizon
+struct PolicyReport
+{
+    int choice;
+    vector<TimelineInterval> timeline;
+    vector<DeadlineMiss> misses;
+    long long preemptions = 0;
+    vector<ResponseStatistics> responses; // per task in task order
+};
+
+class PolicyComparison
+{
+public:
+    // choices among CHOICE_RM, CHOICE_DM, CHOICE_EDF and CHOICE_LST; throws runtime_error for
+    // an empty set or a task without a positive WCET and period
+    PolicyComparison(const vector<Task> &tasks, const vector<int> &choices);
+    // horizon == 0 compares over one hyperperiod; the timelines all cover [0, horizon)
+    void run(long long horizon = 0, bool parallel = false);
+    const vector<Task> &getTasks() const;
+    const vector<PolicyReport> &getReports() const;
+    // One row per policy: misses, preemptions and the worst response of every task
+    void writeReport(ostream &out) const;
+
+private:
+    vector<Task> tasks;
+    vector<Scheduler> schedulers;
+    vector<PolicyReport> reports;
+};
+
+// RM, DM, EDF or LST
+string policyName(int choice);
+
+#endif
@@ -0,0 +1,287 @@
+#include "corpus.hpp"
+#include "task_file.hpp"
+#include "instrumentation.hpp"
+#include <charconv>
+#include <cstring>
+
+size_t TaskSetBatch::size() const
+{
+    return offsets.size() - 1;
+}
+
+vector<Task> TaskSetBatch::set(size_t k) const
+{
+    if (k >= size())
+        throw runtime_error("Invalid task set index");
+    return vector<Task>(tasks.begin() + offsets[k], tasks.begin() + offsets[k + 1]);
+}
+
+size_t JobSetBatch::size() const
+{
+    return offsets.size() - 1;
+}
+
+vector<Job> JobSetBatch::set(size_t k) const
+{
+    if (k >= size())
+        throw runtime_error("Invalid task set index");
+    return vector<Job>(jobs.begin() + offsets[k], jobs.begin() + offsets[k + 1]);
+}
+
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char *lineEnd(const char *p, const char *end)
+{
+    const char *newline = static_cast<const char *>(memchr(p, '\n', end - p));
+    return newline ? newline : end;
+}
+
+static bool isBlankLine(const char *p, const char *end)
+{
+    while (p < end && isBlank(*p))
+        p++;
+    return p == end;
+}
+
+vector<CorpusChunk> splitCorpus(const char *data, size_t size, size_t count)
+{
+    vector<CorpusChunk> chunks;
+    const char *end = data + size;
+    size_t begin = 0;
+    for (size_t k = 1; k <= count && begin < size; ++k)
+    {
+        size_t cut = size;
+        if (k < count)
+        {
+            // from the next line start after the even cut, skip lines up to and including a blank one
+            const char *p = data + max(begin, size / count * k);
+            if (p > data && p[-1] != '\n')
+            {
+                p = lineEnd(p, end);
+                p += p < end;
+            }
+            while (p < end)
+            {
+                const char *next = lineEnd(p, end);
+                bool blank = isBlankLine(p, next);
+                p = next + (next < end);
+                if (blank)
+                    break;
+            }
+            cut = p - data;
+        }
+        if (cut > begin)
+            chunks.push_back({begin, cut});
+        begin = cut;
+    }
+    return chunks;
+}
+
+// Walks one record, parsing integers in place
+class RecordCursor
+{
+public:
+    RecordCursor(const char *p, const char *end, const char *base) : p(p), end(end), base(base), start(p) {}
+
+    int number()
+    {
+        skipBlanks();
+        int value = 0;
+        auto result = from_chars(p, end, value);
+        if (result.ec != errc())
+            fail("expected a number");
+        p = result.ptr;
+        skipBlanks();
+        return value;
+    }
+
+    bool accept(char c)
+    {
+        skipBlanks();
+        if (p < end && *p == c)
+        {
+            p++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!accept(c))
+            fail(string("expected '") + c + "'");
+    }
+
+    bool atEnd()
+    {
+        skipBlanks();
+        return p == end;
+    }
+
+    char peek()
+    {
+        skipBlanks();
+        return p < end ? *p : '\0';
+    }
+
+    // "1:4(2:2);2:1", ending at ',' or the end of the record
+    vector<ResourceRequest> sections()
+    {
+        vector<ResourceRequest> requests;
+        while (!atEnd() && peek() != ',' && peek() != ')')
+        {
+            if (accept(';'))
+                continue;
+            ResourceRequest request;
+            request.id = number();
+            expect(':');
+            request.duration = number();
+            if (accept('('))
+            {
+                request.nested = sections();
+                expect(')');
+            }
+            requests.push_back(std::move(request));
+        }
+        return requests;
+    }
+
+    [[noreturn]] void fail(const string &reason)
+    {
+        throw runtime_error("corpus byte " + to_string(p - base) + ": " + reason);
+    }
+
+    // checkTiming, reporting the offset of the record rather than of the cursor
+    void checkTiming(long long WCET, long long period, long long deadline)
+    {
+        try
+        {
+            ::checkTiming(WCET, period, deadline);
+        }
+        catch (const runtime_error &error)
+        {
+            throw runtime_error("corpus byte " + to_string(start - base) + ": " + error.what());
+        }
+    }
+
+private:
+    void skipBlanks()
+    {
+        while (p < end && isBlank(*p))
+            p++;
+    }
+
+    const char *p;
+    const char *end;
+    const char *base;
+    const char *start;
+};
+
+// Calls parse on every record line and closes a set at every blank line
+template <typename Parse>
+static void forEachRecord(const char *begin, const char *end, vector<size_t> &offsets, const size_t &stored, Parse parse)
+{
+    for (const char *p = begin; p < end;)
+    {
+        const char *next = lineEnd(p, end);
+        if (isBlankLine(p, next))
+        {
+            if (stored > offsets.back())
+                offsets.push_back(stored);
+        }
+        else
+        {
+            const char *first = p;
+            while (isBlank(*first))
+                first++;
+            if (isdigit(static_cast<unsigned char>(*first)) || *first == '-')
+                parse(RecordCursor(first, next, begin));
+        }
+        p = next + (next < end);
+    }
+    if (stored > offsets.back())
+        offsets.push_back(stored);
+}
+
+void parseTaskSets(const char *begin, const char *end, TaskSetBatch &batch)
+{
+    size_t stored = batch.tasks.size();
+    forEachRecord(begin, end, batch.offsets, stored, [&](RecordCursor record) {
+        Task task;
+        task.id = record.number();
+        record.expect(',');
+        task.WCET = record.number();
+        record.expect(',');
+        task.period = record.number();
+        record.expect(',');
+        task.deadline = record.number();
+        task.priority = 0;
+        if (!record.atEnd())
+            record.fail("expected the end of the record");
+        record.checkTiming(task.WCET, task.period, task.deadline);
+        batch.tasks.push_back(task);
+        stored++;
+    });
+}
+
+void parseJobSets(const char *begin, const char *end, JobSetBatch &batch)
+{
+    size_t stored = batch.jobs.size();
+    forEachRecord(begin, end, batch.offsets, stored, [&](RecordCursor record) {
+        batch.jobs.emplace_back();
+        Job &job = batch.jobs.back();
+        job.id = record.number();
+        record.expect(',');
+        job.releaseTime = record.number();
+        record.expect(',');
+        job.WCET = record.number();
+        record.expect(',');
+        job.basePriority = record.number();
+        record.expect(',');
+        job.period = record.number();
+        record.expect(',');
+        job.deadline = record.number();
+        if (record.accept(','))
+            job.resourceSequence = record.sections();
+        if (record.accept(','))
+            job.stackSize = record.number();
+        if (!record.atEnd())
+            record.fail("expected the end of the record");
+        // a job's deadline is absolute
+        record.checkTiming(job.WCET, job.period, static_cast<long long>(job.deadline) - job.releaseTime);
+        stored++;
+    });
+}
+
+TaskSetCorpus::TaskSetCorpus(const string &path) : file(path)
+{
+}
+
+size_t TaskSetCorpus::size() const
+{
+    return file.size();
+}
+
+vector<CorpusChunk> TaskSetCorpus::split(size_t count) const
+{
+    return splitCorpus(file.data(), file.size(), max<size_t>(count, 1));
+}
+
+TaskSetBatch TaskSetCorpus::parseTasks(const CorpusChunk &chunk) const
+{
+    INSTRUMENT_PHASE(PHASE_PARSE);
+    TaskSetBatch batch;
+    parseTaskSets(file.data() + chunk.begin, file.data() + chunk.end, batch);
+    return batch;
+}
+
+JobSetBatch TaskSetCorpus::parseJobs(const CorpusChunk &chunk) const
+{
+    INSTRUMENT_PHASE(PHASE_PARSE);
+    JobSetBatch batch;
+    parseJobSets(file.data() + chunk.begin, file.data() + chunk.end, batch);
+    return batch;
+}
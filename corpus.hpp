@@ -0,0 +1,62 @@
+// Reader for large text corpora of task sets. The file is memory-mapped and integers are
+// parsed with from_chars straight into Task and Job storage, with no stream or string copies.
+//
+// A corpus holds task sets separated by blank lines, one task per line in the CSV layouts
+// of task_file.hpp. Lines starting with anything other than a digit or '-' (comments,
+// headers) are skipped. splitCorpus() cuts the file into chunks that each hold whole task
+// sets, so every chunk can be parsed and analyzed on its own thread.
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+#include "scheduler.hpp"
+#include "mapped_file.hpp"
+
+// A byte range of the corpus that starts and ends on task set boundaries
+struct CorpusChunk
+{
+    size_t begin;
+    size_t end;
+};
+
+// Task sets stored back to back: set k is tasks[offsets[k], offsets[k + 1])
+struct TaskSetBatch
+{
+    vector<Task> tasks;
+    vector<size_t> offsets = {0};
+
+    size_t size() const;
+    vector<Task> set(size_t k) const;
+};
+
+struct JobSetBatch
+{
+    vector<Job> jobs;
+    vector<size_t> offsets = {0};
+
+    size_t size() const;
+    vector<Job> set(size_t k) const;
+};
+
+// Splits [0, size) into at most count chunks of roughly equal size, moving every cut
+// forward to the next blank line
+vector<CorpusChunk> splitCorpus(const char *data, size_t size, size_t count);
+
+// Both append to the batch and throw runtime_error with the offset from begin of a bad record,
+// which includes one whose WCET, period or relative deadline is not positive
+void parseTaskSets(const char *begin, const char *end, TaskSetBatch &batch);
+void parseJobSets(const char *begin, const char *end, JobSetBatch &batch);
+
+class TaskSetCorpus
+{
+public:
+    explicit TaskSetCorpus(const string &path);
+
+    size_t size() const;
+    vector<CorpusChunk> split(size_t count) const;
+    TaskSetBatch parseTasks(const CorpusChunk &chunk) const;
+    JobSetBatch parseJobs(const CorpusChunk &chunk) const;
+
+private:
+    MappedFile file;
+};
+
+#endif // CORPUS_HPP
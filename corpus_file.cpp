@@ -0,0 +1,370 @@
+#include "corpus_file.hpp"
+#include "task_file.hpp"
+#include <cstring>
+
+static const char corpusMagic[8] = {'T', 'A', 'S', 'K', 'C', 'O', 'R', 'P'};
+static const uint32_t corpusVersion = 1;
+
+// Appends fixed-width records, or their fields as zigzag varints when compressing
+class PayloadEncoder
+{
+public:
+    explicit PayloadEncoder(bool compressed) : compressed(compressed) {}
+
+    void field(int32_t value)
+    {
+        if (!compressed)
+        {
+            append(&value, sizeof(value));
+            return;
+        }
+        uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+        while (zigzag >= 0x80)
+        {
+            bytes.push_back(static_cast<char>(zigzag | 0x80));
+            zigzag >>= 7;
+        }
+        bytes.push_back(static_cast<char>(zigzag));
+    }
+
+    void count(size_t value)
+    {
+        field(static_cast<int32_t>(value));
+    }
+
+    // keeps the next fixed-width record 8-byte aligned in the file
+    void align()
+    {
+        if (!compressed)
+            bytes.resize((bytes.size() + 7) / 8 * 8, 0);
+    }
+
+    vector<char> bytes;
+
+private:
+    void append(const void *data, size_t size)
+    {
+        const char *p = static_cast<const char *>(data);
+        bytes.insert(bytes.end(), p, p + size);
+    }
+
+    bool compressed;
+};
+
+class PayloadDecoder
+{
+public:
+    PayloadDecoder(const char *p, const char *end, bool compressed) : p(p), end(end), compressed(compressed) {}
+
+    int32_t field()
+    {
+        if (!compressed)
+        {
+            if (end - p < static_cast<ptrdiff_t>(sizeof(int32_t)))
+                throw runtime_error("Truncated corpus set");
+            int32_t value;
+            memcpy(&value, p, sizeof(value));
+            p += sizeof(value);
+            return value;
+        }
+        uint32_t zigzag = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            if (p == end || shift > 28)
+                throw runtime_error("Truncated corpus set");
+            unsigned char byte = static_cast<unsigned char>(*p++);
+            zigzag |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+        return static_cast<int32_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    }
+
+    size_t count()
+    {
+        return static_cast<uint32_t>(field());
+    }
+
+private:
+    const char *p;
+    const char *end;
+    bool compressed;
+};
+
+// checkTiming naming the set and the task or job that fails it
+static void checkRecord(size_t set, int id, long long WCET, long long period, long long deadline)
+{
+    try
+    {
+        checkTiming(WCET, period, deadline);
+    }
+    catch (const runtime_error &error)
+    {
+        throw runtime_error("Corpus set " + to_string(set) + ", id " + to_string(id) + ": " + error.what());
+    }
+}
+
+static void encodeSections(PayloadEncoder &encoder, const vector<ResourceRequest> &requests)
+{
+    for (const auto &request : requests)
+    {
+        encoder.field(request.id);
+        encoder.field(request.duration);
+        encoder.count(request.nested.size());
+        encoder.field(0);
+        encodeSections(encoder, request.nested);
+    }
+}
+
+static size_t countSections(const vector<ResourceRequest> &requests)
+{
+    size_t count = requests.size();
+    for (const auto &request : requests)
+        count += countSections(request.nested);
+    return count;
+}
+
+// Rebuilds count sibling sections and their subtrees from the pre-order list
+static vector<ResourceRequest> decodeSections(PayloadDecoder &decoder, size_t count, size_t &remaining)
+{
+    vector<ResourceRequest> requests;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (remaining == 0)
+            throw runtime_error("Corrupt corpus sections");
+        remaining--;
+        ResourceRequest request;
+        request.id = decoder.field();
+        request.duration = decoder.field();
+        size_t nested = decoder.count();
+        decoder.field();
+        request.nested = decodeSections(decoder, nested, remaining);
+        requests.push_back(std::move(request));
+    }
+    return requests;
+}
+
+CorpusWriter::CorpusWriter(const string &path, int kind, bool compressed) : file(fopen(path.c_str(), "wb")), header()
+{
+    if (!file)
+        throw runtime_error("Cannot open " + path);
+    header.version = corpusVersion;
+    header.kind = static_cast<uint32_t>(kind);
+    header.compressed = compressed ? 1 : 0;
+    // the header is rewritten with the magic by finish()
+    if (fwrite(&header, sizeof(header), 1, file) != 1)
+        throw runtime_error("Failed to write corpus");
+    written = sizeof(header);
+}
+
+CorpusWriter::~CorpusWriter()
+{
+    if (file)
+        fclose(file);
+}
+
+void CorpusWriter::writePayload(const vector<char> &payload)
+{
+    offsets.push_back(written);
+    if (!payload.empty() && fwrite(payload.data(), 1, payload.size(), file) != payload.size())
+        throw runtime_error("Failed to write corpus");
+    written += payload.size();
+}
+
+void CorpusWriter::addTaskSet(const vector<Task> &tasks)
+{
+    if (header.kind != CORPUS_TASKS)
+        throw runtime_error("Not a task set corpus");
+    PayloadEncoder encoder(header.compressed);
+    encoder.count(tasks.size());
+    encoder.field(0);
+    for (const auto &task : tasks)
+    {
+        checkRecord(offsets.size(), task.id, task.WCET, task.period, task.deadline);
+        encoder.field(task.id);
+        encoder.field(task.WCET);
+        encoder.field(task.period);
+        encoder.field(task.deadline);
+    }
+    encoder.align();
+    writePayload(encoder.bytes);
+}
+
+void CorpusWriter::addJobSet(const vector<Job> &jobs)
+{
+    if (header.kind != CORPUS_JOBS)
+        throw runtime_error("Not a job set corpus");
+    PayloadEncoder encoder(header.compressed);
+    size_t sections = 0;
+    for (const auto &job : jobs)
+    {
+        // a job's deadline is absolute
+        checkRecord(offsets.size(), job.id, job.WCET, job.period, static_cast<long long>(job.deadline) - job.releaseTime);
+        sections += countSections(job.resourceSequence);
+    }
+    encoder.count(jobs.size());
+    encoder.count(sections);
+    for (const auto &job : jobs)
+    {
+        encoder.field(job.id);
+        encoder.field(job.releaseTime);
+        encoder.field(job.WCET);
+        encoder.field(job.basePriority);
+        encoder.field(job.period);
+        encoder.field(job.deadline);
+        encoder.field(job.stackSize);
+        encoder.count(countSections(job.resourceSequence));
+    }
+    for (const auto &job : jobs)
+        encodeSections(encoder, job.resourceSequence);
+    encoder.align();
+    writePayload(encoder.bytes);
+}
+
+void CorpusWriter::finish()
+{
+    if (!file)
+        return;
+    // compressed payloads leave the end unaligned, and the offset table is mapped as uint64s
+    static const char padding[8] = {};
+    size_t pad = (8 - written % 8) % 8;
+    if (pad > 0 && fwrite(padding, 1, pad, file) != pad)
+        throw runtime_error("Failed to write corpus");
+    offsets.push_back(written);
+    written += pad;
+    header.setCount = offsets.size() - 1;
+    header.offsetTableOffset = written;
+    memcpy(header.magic, corpusMagic, sizeof(corpusMagic));
+    bool ok = fwrite(offsets.data(), sizeof(uint64_t), offsets.size(), file) == offsets.size() &&
+              fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    if (!ok)
+        throw runtime_error("Failed to write corpus");
+}
+
+CorpusFile::CorpusFile(const string &path) : file(path)
+{
+    const char *data = file.data();
+    size_t size = file.size();
+    header = reinterpret_cast<const CorpusFileHeader *>(data);
+    if (!data || size < sizeof(CorpusFileHeader) || memcmp(header->magic, corpusMagic, sizeof(corpusMagic)) != 0 ||
+        header->version != corpusVersion || header->kind > CORPUS_JOBS ||
+        header->offsetTableOffset % 8 != 0 || header->offsetTableOffset > size ||
+        header->setCount >= (size - header->offsetTableOffset) / sizeof(uint64_t))
+        throw runtime_error("Invalid corpus file " + path);
+    offsets = reinterpret_cast<const uint64_t *>(data + header->offsetTableOffset);
+    for (uint64_t k = 0; k <= header->setCount; ++k)
+    {
+        if (offsets[k] < sizeof(CorpusFileHeader) || offsets[k] > header->offsetTableOffset || (k > 0 && offsets[k] < offsets[k - 1]))
+            throw runtime_error("Invalid corpus file " + path);
+    }
+}
+
+size_t CorpusFile::size() const
+{
+    return static_cast<size_t>(header->setCount);
+}
+
+int CorpusFile::getKind() const
+{
+    return static_cast<int>(header->kind);
+}
+
+bool CorpusFile::isCompressed() const
+{
+    return header->compressed != 0;
+}
+
+const char *CorpusFile::payload(size_t k, size_t &length) const
+{
+    if (k >= header->setCount)
+        throw runtime_error("Invalid task set index");
+    length = static_cast<size_t>(offsets[k + 1] - offsets[k]);
+    return file.data() + offsets[k];
+}
+
+const CorpusTaskRecord *CorpusFile::taskRecords(size_t k, size_t &count) const
+{
+    if (header->kind != CORPUS_TASKS || header->compressed)
+        throw runtime_error("Task records are only mapped from uncompressed task corpora");
+    size_t length;
+    const char *p = payload(k, length);
+    uint32_t stored;
+    memcpy(&stored, p, sizeof(stored));
+    if (length < 8 || stored > (length - 8) / sizeof(CorpusTaskRecord))
+        throw runtime_error("Truncated corpus set");
+    count = stored;
+    const CorpusTaskRecord *records = reinterpret_cast<const CorpusTaskRecord *>(p + 8);
+    // the file is untrusted input, so a view is only handed out once every record checks out
+    for (size_t i = 0; i < count; ++i)
+        checkRecord(k, records[i].id, records[i].WCET, records[i].period, records[i].deadline);
+    return records;
+}
+
+vector<Task> CorpusFile::taskSet(size_t k) const
+{
+    if (header->kind != CORPUS_TASKS)
+        throw runtime_error("Not a task set corpus");
+    size_t length;
+    const char *p = payload(k, length);
+    PayloadDecoder decoder(p, p + length, header->compressed);
+    size_t count = decoder.count();
+    decoder.field();
+    vector<Task> tasks;
+    tasks.reserve(min(count, length));
+    for (size_t i = 0; i < count; ++i)
+    {
+        Task task;
+        task.id = decoder.field();
+        task.WCET = decoder.field();
+        task.period = decoder.field();
+        task.deadline = decoder.field();
+        task.priority = 0;
+        checkRecord(k, task.id, task.WCET, task.period, task.deadline);
+        tasks.push_back(task);
+    }
+    return tasks;
+}
+
+vector<Job> CorpusFile::jobSet(size_t k) const
+{
+    if (header->kind != CORPUS_JOBS)
+        throw runtime_error("Not a job set corpus");
+    size_t length;
+    const char *p = payload(k, length);
+    PayloadDecoder decoder(p, p + length, header->compressed);
+    size_t count = decoder.count();
+    size_t sections = decoder.count();
+    vector<Job> jobs(min(count, length));
+    if (jobs.size() != count)
+        throw runtime_error("Truncated corpus set");
+    vector<size_t> sectionCounts(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Job &job = jobs[i];
+        job.id = decoder.field();
+        job.releaseTime = decoder.field();
+        job.WCET = decoder.field();
+        job.basePriority = decoder.field();
+        job.period = decoder.field();
+        job.deadline = decoder.field();
+        job.stackSize = decoder.field();
+        sectionCounts[i] = decoder.count();
+        checkRecord(k, job.id, job.WCET, job.period, static_cast<long long>(job.deadline) - job.releaseTime);
+    }
+    // each job's sections are top-level siblings until its count is used up
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t remaining = sectionCounts[i];
+        if (remaining > sections)
+            throw runtime_error("Corrupt corpus sections");
+        sections -= remaining;
+        while (remaining > 0)
+        {
+            vector<ResourceRequest> section = decodeSections(decoder, 1, remaining);
+            jobs[i].resourceSequence.push_back(std::move(section[0]));
+        }
+    }
+    return jobs;
+}
@@ -0,0 +1,105 @@
+// Binary task set corpus, written by generators and read back without parsing:
+//
+//   header | set payloads | offset table
+//
+// The offset table holds setCount + 1 payload offsets, so set k is found in O(1).
+// A task set payload is a uint32 count followed by fixed-width CorpusTaskRecords.
+// A job set payload is a uint32 job count and a uint32 section count, then the job records,
+// then every job's critical sections in pre-order as CorpusSectionRecords.
+// A compressed corpus stores each payload as zigzag varints of the same fields instead,
+// trading the zero-copy access for a file several times smaller.
+#ifndef CORPUS_FILE_HPP
+#define CORPUS_FILE_HPP
+#include "scheduler.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+#include <cstdio>
+
+#define CORPUS_TASKS 0
+#define CORPUS_JOBS 1
+
+struct CorpusFileHeader
+{
+    char magic[8]; // "TASKCORP"
+    uint32_t version;
+    uint32_t kind;       // CORPUS_TASKS or CORPUS_JOBS
+    uint32_t compressed; // 1 when payloads are varint encoded
+    uint32_t reserved;
+    uint64_t setCount;
+    uint64_t offsetTableOffset;
+};
+
+struct CorpusTaskRecord
+{
+    int32_t id;
+    int32_t WCET;
+    int32_t period;
+    int32_t deadline;
+};
+
+struct CorpusJobRecord
+{
+    int32_t id;
+    int32_t releaseTime;
+    int32_t WCET;
+    int32_t basePriority;
+    int32_t period;
+    int32_t deadline;
+    int32_t stackSize;
+    uint32_t sectionCount; // sections of this job, nested ones included
+};
+
+struct CorpusSectionRecord
+{
+    int32_t resourceId;
+    int32_t duration;
+    uint32_t nestedCount; // direct children, which follow it in pre-order
+    uint32_t reserved;
+};
+
+class CorpusWriter
+{
+public:
+    CorpusWriter(const string &path, int kind, bool compressed = false);
+    ~CorpusWriter();
+    // Both throw runtime_error and write nothing when a WCET, period or relative deadline is
+    // not positive
+    void addTaskSet(const vector<Task> &tasks);
+    void addJobSet(const vector<Job> &jobs);
+    // Writes the offset table and the header; the file is unreadable until then
+    void finish();
+
+private:
+    void writePayload(const vector<char> &payload);
+
+    FILE *file;
+    CorpusFileHeader header;
+    vector<uint64_t> offsets;
+    uint64_t written = 0;
+};
+
+class CorpusFile
+{
+public:
+    explicit CorpusFile(const string &path);
+
+    size_t size() const;
+    int getKind() const;
+    bool isCompressed() const;
+
+    // Zero-copy view of task set k; only for uncompressed task corpora
+    const CorpusTaskRecord *taskRecords(size_t k, size_t &count) const;
+    vector<Task> taskSet(size_t k) const;
+    vector<Job> jobSet(size_t k) const;
+    // all three check the records again, as the mapped file may have been altered since it was
+    // written, and throw runtime_error on a non-positive WCET, period or relative deadline
+
+private:
+    const char *payload(size_t k, size_t &length) const;
+
+    MappedFile file;
+    const CorpusFileHeader *header = nullptr;
+    const uint64_t *offsets = nullptr;
+};
+
+#endif // CORPUS_FILE_HPP
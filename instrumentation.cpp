@@ -0,0 +1,83 @@
+#include "instrumentation.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+
+static const char *counterNames[COUNTER_COUNT] = {"rtaIterations", "pdcPoints", "opaCandidates", "simulationTicks",
+                                                  "simulationEvents", "readyQueueOps", "blockingEvents", "inheritanceEvents"};
+static const char *phaseNames[PHASE_COUNT] = {"parse", "analyze", "simulate", "render"};
+
+static atomic<long long> counters[COUNTER_COUNT];
+static atomic<long long> phaseNanoseconds[PHASE_COUNT];
+static atomic<long long> phaseCalls[PHASE_COUNT];
+// once per computeResponseTime call rather than per iteration, so a lock is cheap enough
+static mutex taskIterationsLock;
+static map<int, long long> taskIterations;
+
+bool instrumentationEnabled()
+{
+#ifdef SCHEDULER_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+void addToCounter(int counter, long long amount)
+{
+    counters[counter].fetch_add(amount, memory_order_relaxed);
+}
+
+void addTaskIterations(int taskId, long long iterations)
+{
+    addToCounter(COUNTER_RTA_ITERATIONS, iterations);
+    lock_guard<mutex> guard(taskIterationsLock);
+    taskIterations[taskId] += iterations;
+}
+
+void addPhaseTime(int phase, chrono::nanoseconds elapsed)
+{
+    phaseNanoseconds[phase].fetch_add(elapsed.count(), memory_order_relaxed);
+    phaseCalls[phase].fetch_add(1, memory_order_relaxed);
+}
+
+void resetInstrumentation()
+{
+    for (auto &counter : counters)
+        counter = 0;
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        phaseNanoseconds[phase] = 0;
+        phaseCalls[phase] = 0;
+    }
+    lock_guard<mutex> guard(taskIterationsLock);
+    taskIterations.clear();
+}
+
+void writeInstrumentation(ostream &out)
+{
+    out << "{\"enabled\":" << (instrumentationEnabled() ? "true" : "false");
+    if (!instrumentationEnabled())
+    {
+        out << "}\n";
+        return;
+    }
+    out << ",\"counters\":{";
+    for (int counter = 0; counter < COUNTER_COUNT; ++counter)
+        out << (counter ? "," : "") << "\"" << counterNames[counter] << "\":" << counters[counter].load();
+    out << "},\"rtaIterationsPerTask\":{";
+    {
+        lock_guard<mutex> guard(taskIterationsLock);
+        bool first = true;
+        for (const auto &task : taskIterations)
+        {
+            out << (first ? "" : ",") << "\"" << task.first << "\":" << task.second;
+            first = false;
+        }
+    }
+    out << "},\"phases\":{";
+    for (int phase = 0; phase < PHASE_COUNT; ++phase)
+        out << (phase ? "," : "") << "\"" << phaseNames[phase] << "\":{\"calls\":" << phaseCalls[phase].load()
+            << ",\"seconds\":" << phaseNanoseconds[phase].load() / 1e9 << "}";
+    out << "}}\n";
+}
@@ -0,0 +1,62 @@
+// Counters and phase timers for profiling the analyses and simulators in production runs.
+// They are compiled in only when SCHEDULER_INSTRUMENTATION is defined (the CMake option of
+// the same name); otherwise the INSTRUMENT_* macros expand to nothing and cost nothing.
+// Counters are atomic, so concurrent Scheduler instances may share them.
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+using namespace std;
+#include <iostream>
+#include <chrono>
+
+#define COUNTER_RTA_ITERATIONS 0      // response-time fixed-point iterations, also kept per task
+#define COUNTER_PDC_POINTS 1          // processor demand checkpoints evaluated
+#define COUNTER_OPA_CANDIDATES 2      // tasks tried at an OPA priority level
+#define COUNTER_SIMULATION_TICKS 3    // ticks simulated by Scheduler and Inheritance
+#define COUNTER_SIMULATION_EVENTS 4   // scheduling decisions of the event-based LST simulator
+#define COUNTER_READY_QUEUE_OPS 5     // jobs added to or removed from the pending queues
+#define COUNTER_BLOCKING_EVENTS 6     // Inheritance: a job blocked on a resource
+#define COUNTER_INHERITANCE_EVENTS 7  // Inheritance: a priority raised by inheritance or a ceiling
+#define COUNTER_COUNT 8
+
+#define PHASE_PARSE 0
+#define PHASE_ANALYZE 1
+#define PHASE_SIMULATE 2
+#define PHASE_RENDER 3
+#define PHASE_COUNT 4
+
+// True when built with SCHEDULER_INSTRUMENTATION
+bool instrumentationEnabled();
+void addToCounter(int counter, long long amount);
+// RTA iterations are also broken down by task id
+void addTaskIterations(int taskId, long long iterations);
+void addPhaseTime(int phase, chrono::nanoseconds elapsed);
+void resetInstrumentation();
+// {"enabled":..., "counters":{...}, "rtaIterationsPerTask":{...}, "phases":{...}}
+void writeInstrumentation(ostream &out);
+
+// Adds the time from construction to destruction to a phase
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(int phase) : phase(phase), start(chrono::steady_clock::now()) {}
+    ~PhaseTimer() { addPhaseTime(phase, chrono::steady_clock::now() - start); }
+
+private:
+    int phase;
+    chrono::steady_clock::time_point start;
+};
+
+#define INSTRUMENT_JOIN2(a, b) a##b
+#define INSTRUMENT_JOIN(a, b) INSTRUMENT_JOIN2(a, b)
+#ifdef SCHEDULER_INSTRUMENTATION
+#define INSTRUMENT_COUNT(counter, amount) addToCounter(counter, amount)
+#define INSTRUMENT_TASK_ITERATIONS(taskId, iterations) addTaskIterations(taskId, iterations)
+// Times the rest of the enclosing scope
+#define INSTRUMENT_PHASE(phase) PhaseTimer INSTRUMENT_JOIN(phaseTimer, __LINE__)(phase)
+#else
+#define INSTRUMENT_COUNT(counter, amount) ((void)0)
+#define INSTRUMENT_TASK_ITERATIONS(taskId, iterations) ((void)0)
+#define INSTRUMENT_PHASE(phase) ((void)0)
+#endif
+
+#endif
@@ -1,7 +1,13 @@
 #include "scheduler.hpp"
+#include "analysis.hpp"
+#include "timeline_query.hpp"
+#include "cli.hpp"
 using namespace std;
 
-int main(){
+int main(int argc, char **argv){
+    if (argc > 1)
+        return runCommandLine(argc, argv);
+
     int choice;
     cout << "Choose a scheduling algorithm:\n";
     cout << CHOICE_RM << ". Rate-Monotonic (RM)\n";
@@ -12,10 +18,11 @@ int main(){
     cout << CHOICE_OCPP << ". Original Ceiling Priority Protocol (OCPP)\n";
     cout << CHOICE_ICPP << ". Immediate Ceiling Priority Protocol (ICPP)\n";
     cout << CHOICE_ARB_DEADLINE << ". Arbitrary Deadlines\n";
-    cout << "Enter your choice (1-8): ";
+    cout << CHOICE_SRP << ". Stack Resource Policy with EDF (SRP)\n";
+    cout << "Enter your choice (1-9): ";
     cin >> choice;
 
-    if (choice < CHOICE_RM || choice > CHOICE_ARB_DEADLINE){
+    if (choice < CHOICE_RM || choice > CHOICE_SRP){
         cout << "Invalid Input\n";
         return 1;
     }
@@ -27,12 +34,19 @@ int main(){
         return 1;
     }
     int numResources;
-    if (choice == CHOICE_PIP || choice == CHOICE_OCPP || choice == CHOICE_ICPP) {
+    int horizon = 0;
+    if (choice == CHOICE_PIP || choice == CHOICE_OCPP || choice == CHOICE_ICPP || choice == CHOICE_SRP) {
 		cout << "Enter the number of resources: ";
 		cin >> numResources;
         if (numResources <= 0) {
             cout << "Invalid number of resources. Exiting.\n";
             return 1;
+        }
+		cout << "Enter the simulation horizon (0 to run each job once): ";
+		cin >> horizon;
+        if (horizon < 0) {
+            cout << "Invalid horizon. Exiting.\n";
+            return 1;
         }
     }
 	
@@ -40,7 +54,7 @@ int main(){
     vector<Task> tasks;
 	vector<Job> jobs;
     for (int i = 0; i < numTasks; ++i){
-        if (choice == CHOICE_PIP || choice == CHOICE_OCPP || choice == CHOICE_ICPP){
+        if (choice == CHOICE_PIP || choice == CHOICE_OCPP || choice == CHOICE_ICPP || choice == CHOICE_SRP){
 			int numRes;
 			Job job;
 			job.id = i + 1;
@@ -80,10 +94,20 @@ int main(){
             if (scheduler.runOPA())
                 scheduler.generateTimeline();
         }
+        if (!scheduler.timeline.empty())
+        {
+            cout << "\nTimeline (0 to " << scheduler.computeHyperperiod() << "):\n" << formatTimeline(scheduler.timeline) << "\n";
+            scheduler.displayResponseStatistics();
+        }
         scheduler.displayTimeline();// display the timeline
     }
-    else if (choice == CHOICE_PIP || choice == CHOICE_OCPP || choice == CHOICE_ICPP){
-		Inheritance inheritance(jobs, numResources, choice);
+    else if (choice == CHOICE_PIP || choice == CHOICE_OCPP || choice == CHOICE_ICPP || choice == CHOICE_SRP){
+		Inheritance inheritance(jobs, numResources, choice, horizon);
+        BlockingAnalysis analysis(inheritance);
+        if (choice == CHOICE_SRP)
+            analysis.runSRPDemandTest();
+        else
+            analysis.runRTATest();
 		inheritance.simulateResource();
         if (inheritance.allTasksFinished()) {
             cout << "All tasks finished successfully.\n";
@@ -0,0 +1,660 @@
+#include "render.hpp"
+#include <filesystem>
+
+using namespace std;
+
+static const TimelineStyle schedulerStyle = {20, 50, 0, 80, 150};
+static const TimelineStyle inheritanceStyle = {40, 60, 2, 100, 50};
+static const int stepsPerLine = 50;
+static const int marginLeft = 50;
+static const int viewerLaneTop = 60;
+
+static const vector<sf::Color> colors = {
+    sf::Color::Red, sf::Color::Green, sf::Color::Blue,
+    sf::Color::Yellow, sf::Color::Magenta, sf::Color::Cyan,
+    sf::Color(255, 165, 0),   // Orange
+    sf::Color(128, 0, 128),   // Purple
+    sf::Color(0, 128, 128),   // Teal
+    sf::Color(210, 105, 30),  // DBrown
+    sf::Color(75, 0, 130),    // Indigo
+    sf::Color(60, 179, 113),  // LGreen
+    sf::Color(255, 105, 180), // HotPink
+    sf::Color(47, 79, 79),    // DGray
+    sf::Color(255, 215, 0)    // Gold
+};
+
+vector<TimelineRun> timelineRuns(const Scheduler &scheduler)
+{
+    vector<TimelineRun> runs;
+    runs.reserve(scheduler.timeline.size());
+    for (const auto &interval : scheduler.timeline)
+        runs.push_back({interval.start, interval.length, interval.taskId == IDLE_TASK ? "ID" : "T" + to_string(interval.taskId), {}});
+    return runs;
+}
+
+vector<TimelineRun> timelineRuns(const Inheritance &inheritance)
+{
+    const vector<simulate> &timeline = inheritance.getTimeline();
+    const vector<ResourceHold> &holds = inheritance.getResourceHolds();
+    // runs are cut wherever a lock is taken or released, so the held resources stay put within one
+    vector<int> cuts;
+    for (const auto &hold : holds)
+    {
+        cuts.push_back(hold.start);
+        if (hold.end >= 0)
+            cuts.push_back(hold.end);
+    }
+    sort(cuts.begin(), cuts.end());
+
+    vector<TimelineRun> runs;
+    vector<size_t> active; // holds taken and not yet released at the start of the current run
+    size_t nextHold = 0;
+    size_t nextCut = 0;
+    for (size_t i = 0; i < timeline.size(); ++i)
+    {
+        const simulate &entry = timeline[i];
+        bool cut = false;
+        for (; nextCut < cuts.size() && cuts[nextCut] <= entry.time; ++nextCut)
+            cut = true;
+        if (!runs.empty() && !cut && timeline[i - 1].jobId == entry.jobId)
+        {
+            runs.back().length++;
+            continue;
+        }
+        // holds are in lock order, which is time order
+        for (; nextHold < holds.size() && holds[nextHold].start <= entry.time; ++nextHold)
+            active.push_back(nextHold);
+        active.erase(remove_if(active.begin(), active.end(),
+                               [&](size_t h) { return holds[h].end >= 0 && holds[h].end <= entry.time; }),
+                     active.end());
+        TimelineRun run = {static_cast<long long>(i), 1, "T" + to_string(entry.jobId), {}};
+        for (size_t h : active)
+        {
+            if (holds[h].holder == entry.jobId)
+                run.resources.push_back(holds[h].resourceId);
+        }
+        sort(run.resources.begin(), run.resources.end());
+        runs.push_back(run);
+    }
+    return runs;
+}
+
+static long long stepCount(const vector<TimelineRun> &runs)
+{
+    return runs.empty() ? 0 : runs.back().start + runs.back().length;
+}
+
+TimelineRenderer::TimelineRenderer() : fontLoaded(false), textureSize(0, 0)
+{
+    // the repository ships arial.ttf next to the binaries as a fallback
+    for (const string fontPath : {"C:\\Fonts\\arial.ttf", "arial.ttf"})
+    {
+        if (std::filesystem::exists(fontPath) && font.loadFromFile(fontPath))
+        {
+            fontLoaded = true;
+            return;
+        }
+    }
+    std::cerr << "Failed to load font from C:\\Fonts\\arial.ttf or arial.ttf" << std::endl;
+}
+
+bool TimelineRenderer::isReady() const
+{
+    return fontLoaded;
+}
+
+void TimelineRenderer::display(const Scheduler &scheduler)
+{
+    display(timelineRuns(scheduler), schedulerStyle, "Scheduler Timeline");
+}
+
+void TimelineRenderer::display(const Inheritance &inheritance)
+{
+    display(timelineRuns(inheritance), inheritanceStyle, "Inheritance Simulation Timeline");
+}
+
+int TimelineRenderer::renderToPNG(const Scheduler &scheduler, const string &prefix, int stepsPerImage)
+{
+    return renderToPNG(timelineRuns(scheduler), schedulerStyle, prefix, stepsPerImage);
+}
+
+int TimelineRenderer::renderToPNG(const Inheritance &inheritance, const string &prefix, int stepsPerImage)
+{
+    return renderToPNG(timelineRuns(inheritance), inheritanceStyle, prefix, stepsPerImage);
+}
+
+// Resources get their colors first, then tasks in order of appearance; idle stays black
+void TimelineRenderer::assignColors(const vector<TimelineRun> &runs)
+{
+    taskColors.clear();
+    resourceColors.clear();
+    int colorIndex = 0;
+    for (const auto &run : runs)
+    {
+        for (int id : run.resources)
+        {
+            if (resourceColors.find(id) == resourceColors.end())
+                resourceColors[id] = colors[colorIndex++ % colors.size()];
+        }
+    }
+    for (const auto &run : runs)
+    {
+        if (run.label != "ID" && taskColors.find(run.label) == taskColors.end())
+            taskColors[run.label] = colors[colorIndex++ % colors.size()];
+    }
+}
+
+sf::Vector2u TimelineRenderer::imageSize(long long count, const TimelineStyle &style) const
+{
+    const int blocksPerLine = std::min(stepsPerLine, static_cast<int>(count));
+    const int lines = (static_cast<int>(count) + stepsPerLine - 1) / stepsPerLine;
+    const int legendRows = (static_cast<int>(taskColors.size()) + 4) / 5 + (static_cast<int>(resourceColors.size()) + 4) / 5;
+
+    const unsigned width = blocksPerLine * (style.blockWidth + style.spacing) + marginLeft * 2;
+    const unsigned height = lines * (style.blockHeight + 60) + style.marginTop * 2 + legendRows * 25;
+    return sf::Vector2u(width, height);
+}
+
+// Interactive window over the whole timeline: the mouse wheel or +/- zooms around the cursor,
+// dragging or the arrow keys pan and Home fits everything. Geometry is only rebuilt for the
+// visible range when the view changes.
+void TimelineRenderer::display(const vector<TimelineRun> &runs, const TimelineStyle &style, const string &title)
+{
+    const long long steps = stepCount(runs);
+    if (!fontLoaded || steps == 0)
+        return;
+
+    assignColors(runs);
+    buildLevels(runs);
+    const int legendRows = (static_cast<int>(taskColors.size()) + 4) / 5 + (static_cast<int>(resourceColors.size()) + 4) / 5;
+    sf::Vector2u size(1200, viewerLaneTop + style.blockHeight + 100 + legendRows * 25);
+    sf::RenderWindow window(sf::VideoMode(size.x, size.y), title);
+
+    const double minTicksPerPixel = 1.0 / 40;
+    double ticksPerPixel = 0;
+    double viewStart = 0;
+    auto fit = [&]() {
+        ticksPerPixel = max(minTicksPerPixel, static_cast<double>(steps) / size.x);
+        viewStart = 0;
+    };
+    auto clampView = [&]() {
+        ticksPerPixel = std::clamp(ticksPerPixel, minTicksPerPixel, max(minTicksPerPixel, static_cast<double>(steps) / size.x));
+        viewStart = std::clamp(viewStart, 0.0, max(0.0, steps - size.x * ticksPerPixel));
+    };
+    auto zoom = [&](double factor, int anchorX) {
+        double anchor = viewStart + anchorX * ticksPerPixel;
+        ticksPerPixel *= factor;
+        clampView();
+        viewStart = anchor - anchorX * ticksPerPixel;
+        clampView();
+    };
+    fit();
+
+    TimelineGeometry geometry;
+    bool changed = true;
+    bool dragging = false;
+    int dragX = 0;
+    double dragStart = 0;
+    sf::Event event;
+    while (window.isOpen()) {
+        if (changed) {
+            buildVisibleGeometry(geometry, runs, style, viewStart, ticksPerPixel, size);
+            uploadGeometry(geometry);
+            changed = false;
+        }
+        window.clear(sf::Color::White);
+        drawGeometry(window, geometry);
+        window.display();
+
+        // nothing animates, so block until the next event instead of polling
+        if (!window.waitEvent(event))
+            break;
+        switch (event.type) {
+        case sf::Event::Closed:
+            window.close();
+            break;
+        case sf::Event::Resized:
+            size = sf::Vector2u(event.size.width, event.size.height);
+            window.setView(sf::View(sf::FloatRect(0, 0, size.x, size.y)));
+            clampView();
+            changed = true;
+            break;
+        case sf::Event::MouseWheelScrolled:
+            zoom(event.mouseWheelScroll.delta > 0 ? 0.8 : 1.25, event.mouseWheelScroll.x);
+            changed = true;
+            break;
+        case sf::Event::MouseButtonPressed:
+            dragging = event.mouseButton.button == sf::Mouse::Left;
+            dragX = event.mouseButton.x;
+            dragStart = viewStart;
+            break;
+        case sf::Event::MouseButtonReleased:
+            dragging = false;
+            break;
+        case sf::Event::MouseMoved:
+            if (dragging) {
+                viewStart = dragStart - (event.mouseMove.x - dragX) * ticksPerPixel;
+                clampView();
+                changed = true;
+            }
+            break;
+        case sf::Event::KeyPressed:
+            changed = true;
+            if (event.key.code == sf::Keyboard::Left)
+                viewStart -= size.x * ticksPerPixel / 10;
+            else if (event.key.code == sf::Keyboard::Right)
+                viewStart += size.x * ticksPerPixel / 10;
+            else if (event.key.code == sf::Keyboard::Up || event.key.code == sf::Keyboard::Add || event.key.code == sf::Keyboard::Equal)
+                zoom(0.5, size.x / 2);
+            else if (event.key.code == sf::Keyboard::Down || event.key.code == sf::Keyboard::Subtract || event.key.code == sf::Keyboard::Hyphen)
+                zoom(2, size.x / 2);
+            else if (event.key.code == sf::Keyboard::Home)
+                fit();
+            else
+                changed = false;
+            clampView();
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+int TimelineRenderer::renderToPNG(const vector<TimelineRun> &runs, const TimelineStyle &style, const string &prefix, int stepsPerImage)
+{
+    const long long steps = stepCount(runs);
+    if (!fontLoaded || steps == 0 || stepsPerImage <= 0)
+        return 0;
+
+    assignColors(runs);
+    TimelineGeometry geometry;
+    int images = 0;
+    for (long long first = 0; first < steps; first += stepsPerImage)
+    {
+        const long long count = std::min<long long>(stepsPerImage, steps - first);
+        sf::Vector2u size = imageSize(count, style);
+        // tiles of one batch mostly share a size, so the texture is only recreated when it changes
+        if (size.x != textureSize.x || size.y != textureSize.y)
+        {
+            if (!texture.create(size.x, size.y))
+            {
+                std::cerr << "Failed to create a " << size.x << "x" << size.y << " offscreen texture" << std::endl;
+                return images;
+            }
+            textureSize = size;
+        }
+
+        buildGeometry(geometry, runs, first, count, style);
+        texture.clear(sf::Color::White);
+        drawGeometry(texture, geometry);
+        texture.display();
+
+        string path = prefix + "_" + to_string(images) + ".png";
+        if (!texture.getTexture().copyToImage().saveToFile(path))
+        {
+            std::cerr << "Failed to write " << path << std::endl;
+            return images;
+        }
+        images++;
+    }
+    return images;
+}
+
+static void appendTriangle(sf::VertexArray &vertices, sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, sf::Color color)
+{
+    vertices.append(sf::Vertex(a, color));
+    vertices.append(sf::Vertex(b, color));
+    vertices.append(sf::Vertex(c, color));
+}
+
+static void appendRect(sf::VertexArray &vertices, float x, float y, float width, float height, sf::Color color)
+{
+    appendTriangle(vertices, {x, y}, {x + width, y}, {x + width, y + height}, color);
+    appendTriangle(vertices, {x, y}, {x + width, y + height}, {x, y + height}, color);
+}
+
+static void appendCircle(sf::VertexArray &vertices, float x, float y, float radius, sf::Color color)
+{
+    const int points = 12;
+    const float pi = 3.14159265f;
+    sf::Vector2f center(x + radius, y + radius);
+    for (int i = 0; i < points; ++i)
+    {
+        float a = 2 * pi * i / points;
+        float b = 2 * pi * (i + 1) / points;
+        appendTriangle(vertices, center,
+                       {center.x + radius * cos(a), center.y + radius * sin(a)},
+                       {center.x + radius * cos(b), center.y + radius * sin(b)}, color);
+    }
+}
+
+static void appendLine(sf::VertexArray &vertices, float x1, float y1, float x2, float y2)
+{
+    vertices.append(sf::Vertex(sf::Vector2f(x1, y1), sf::Color::Black));
+    vertices.append(sf::Vertex(sf::Vector2f(x2, y2), sf::Color::Black));
+}
+
+// Lays the text out like sf::Text would, as textured quads from the font's glyph atlas
+void TimelineRenderer::appendText(TimelineGeometry &geometry, const string &text, unsigned size, float x, float y)
+{
+    sf::VertexArray &glyphs = geometry.glyphs[size];
+    glyphs.setPrimitiveType(sf::Triangles);
+    float baseline = y + size;
+    for (char c : text)
+    {
+        const sf::Glyph &glyph = font.getGlyph(static_cast<unsigned char>(c), size, false);
+        float left = x + glyph.bounds.left;
+        float top = baseline + glyph.bounds.top;
+        float right = left + glyph.bounds.width;
+        float bottom = top + glyph.bounds.height;
+        float u1 = glyph.textureRect.left;
+        float v1 = glyph.textureRect.top;
+        float u2 = u1 + glyph.textureRect.width;
+        float v2 = v1 + glyph.textureRect.height;
+
+        glyphs.append(sf::Vertex({left, top}, sf::Color::Black, {u1, v1}));
+        glyphs.append(sf::Vertex({right, top}, sf::Color::Black, {u2, v1}));
+        glyphs.append(sf::Vertex({right, bottom}, sf::Color::Black, {u2, v2}));
+        glyphs.append(sf::Vertex({left, top}, sf::Color::Black, {u1, v1}));
+        glyphs.append(sf::Vertex({right, bottom}, sf::Color::Black, {u2, v2}));
+        glyphs.append(sf::Vertex({left, bottom}, sf::Color::Black, {u1, v2}));
+        x += glyph.advance;
+    }
+}
+
+// Builds every shape of the tile into a few vertex arrays, so drawing it is one call per batch
+void TimelineRenderer::buildGeometry(TimelineGeometry &geometry, const vector<TimelineRun> &runs, long long first, long long count, const TimelineStyle &style)
+{
+    const int blockWidth = style.blockWidth;
+    const int blockHeight = style.blockHeight;
+    const int spacing = style.spacing;
+    const int marginTop = style.marginTop;
+    const int blocksPerLine = std::min(stepsPerLine, static_cast<int>(count));
+    const int lines = (static_cast<int>(count) + stepsPerLine - 1) / stepsPerLine;
+
+    geometry.fills.clear();
+    geometry.fills.setPrimitiveType(sf::Triangles);
+    geometry.lines.clear();
+    geometry.lines.setPrimitiveType(sf::Lines);
+    geometry.glyphs.clear();
+
+    auto run = upper_bound(runs.begin(), runs.end(), first, [](long long step, const TimelineRun &r) { return step < r.start; }) - 1;
+    for (long long i = 0; i < count; ++i) {
+        int row = i / stepsPerLine;
+        int col = i % stepsPerLine;
+        while (run->start + run->length <= first + i)
+            ++run;
+        const TimelineRun &step = *run;
+
+        float x = marginLeft + col * (blockWidth + spacing);
+        float y = marginTop + row * (blockHeight + 60);
+
+        appendRect(geometry.fills, x, y, blockWidth, blockHeight, step.label == "ID" ? sf::Color::Black : taskColors[step.label]);
+
+        // Draw small dots above the task block for each held resource
+        int dotOffset = 0;
+        for (int id : step.resources) {
+            appendCircle(geometry.fills, x + dotOffset * 10, y - 10, 4, resourceColors[id]);
+            dotOffset++;
+        }
+
+        appendText(geometry, step.label, 12, x, y + blockHeight + 2);
+    }
+
+    // Draw horizontal timeline lines and ticks
+    for (int row = 0; row < lines; ++row) {
+        float y = marginTop + row * (blockHeight + 60) + blockHeight + 25;
+        float startX = marginLeft - 10;
+        float endX = marginLeft + blocksPerLine * (blockWidth + spacing);
+
+        appendLine(geometry.lines, startX, y, endX, y);
+
+        //Only draw left arrow for first row
+        if (row == 0)
+            appendTriangle(geometry.fills, {startX, y}, {startX + 7.5f, y - 4.33f}, {startX + 7.5f, y + 4.33f}, sf::Color::Black);
+
+        //Only draw right arrow for the last row
+        if (row == lines - 1)
+            appendTriangle(geometry.fills, {endX + 8, y}, {endX + 0.5f, y + 4.33f}, {endX + 0.5f, y - 4.33f}, sf::Color::Black);
+
+        for (int step = 0; step <= stepsPerLine && (row * stepsPerLine + step) <= static_cast<int>(count); ++step) {
+            float tickX = marginLeft + step * (blockWidth + spacing);
+            appendLine(geometry.lines, tickX, y - 5, tickX, y + 5);
+
+            // labels show absolute time, so tiles continue where the previous one ended
+            long long time = first + row * stepsPerLine + step;
+            if (time % 5 == 0)
+                appendText(geometry, std::to_string(time), 12, tickX - 5, y + 10);
+        }
+    }
+
+    appendLegend(geometry, marginTop + lines * (blockHeight + 60) + 30, style);
+}
+
+// Combined Legend Block (Tasks + Resources)
+void TimelineRenderer::appendLegend(TimelineGeometry &geometry, float legendStartY, const TimelineStyle &style)
+{
+    float legendX = marginLeft;
+    float legendBlockSize = 15;
+    float textOffsetX = legendBlockSize + 5;
+    int maxEntriesPerRow = 5;
+    float entrySpacingY = 25;
+
+    int entries = 0;
+    for (const auto &[taskName, color] : taskColors) {
+        float x = legendX + (entries % maxEntriesPerRow) * style.legendSpacing;
+        float y = legendStartY + (entries / maxEntriesPerRow) * entrySpacingY;
+        appendRect(geometry.fills, x, y, legendBlockSize, legendBlockSize, color);
+        appendText(geometry, taskName, 14, x + textOffsetX, y - 2);
+        entries++;
+    }
+
+    // Resource legend starts below the last row of the task legend
+    int taskLegendRows = (entries + maxEntriesPerRow - 1) / maxEntriesPerRow;
+    float resourceLegendStartY = legendStartY + taskLegendRows * entrySpacingY + 10;
+
+    int rcount = 0;
+    for (const auto &[resID, color] : resourceColors) {
+        float x = legendX + (rcount % maxEntriesPerRow) * style.legendSpacing;
+        float y = resourceLegendStartY + (rcount / maxEntriesPerRow) * entrySpacingY;
+        appendRect(geometry.fills, x, y, legendBlockSize, legendBlockSize, color);
+        appendText(geometry, "R" + std::to_string(resID), 14, x + textOffsetX, y - 2);
+        rcount++;
+    }
+}
+
+// Busy ticks add up exactly; the dominant label is the heavier of the two halves' dominants
+static TimelineSummary mergeSummary(const TimelineSummary &a, const TimelineSummary &b)
+{
+    TimelineSummary merged = a.dominantTicks >= b.dominantTicks ? a : b;
+    if (a.dominant == b.dominant)
+        merged.dominantTicks = a.dominantTicks + b.dominantTicks;
+    merged.busyTicks = a.busyTicks + b.busyTicks;
+    return merged;
+}
+
+void TimelineRenderer::buildLevels(const vector<TimelineRun> &runs)
+{
+    labels.clear();
+    runStarts.clear();
+    levels.assign(1, {});
+    map<string, int> labelIndex;
+    runStarts.reserve(runs.size());
+    levels[0].reserve(runs.size());
+    for (const auto &run : runs)
+    {
+        runStarts.push_back(run.start);
+        if (run.label == "ID")
+        {
+            levels[0].push_back({-1, 0, 0});
+            continue;
+        }
+        auto it = labelIndex.find(run.label);
+        if (it == labelIndex.end())
+        {
+            it = labelIndex.emplace(run.label, static_cast<int>(labels.size())).first;
+            labels.push_back(run.label);
+        }
+        levels[0].push_back({it->second, run.length, run.length});
+    }
+
+    while (levels.back().size() > 1)
+    {
+        const vector<TimelineSummary> &below = levels.back();
+        vector<TimelineSummary> above((below.size() + 1) / 2);
+        for (size_t j = 0; j < above.size(); ++j)
+            above[j] = mergeSummary(below[2 * j], 2 * j + 1 < below.size() ? below[2 * j + 1] : TimelineSummary{-1, 0, 0});
+        levels.push_back(std::move(above));
+    }
+}
+
+TimelineSummary TimelineRenderer::summarize(const vector<TimelineRun> &runs, long long a, long long b) const
+{
+    auto clipped = [&](size_t r) {
+        TimelineSummary summary = levels[0][r];
+        if (summary.dominant >= 0)
+            summary.dominantTicks = summary.busyTicks = min(b, runs[r].start + runs[r].length) - max(a, runs[r].start);
+        return summary;
+    };
+    const size_t first = upper_bound(runStarts.begin(), runStarts.end(), a) - runStarts.begin() - 1;
+    const size_t last = upper_bound(runStarts.begin(), runStarts.end(), b - 1) - runStarts.begin() - 1;
+    TimelineSummary summary = clipped(first);
+    if (last == first)
+        return summary;
+    // the whole runs in between, as the largest aligned blocks of the levels that fit
+    for (size_t j = first + 1; j < last;)
+    {
+        size_t k = 0;
+        while (k + 1 < levels.size() && j % (size_t(2) << k) == 0 && j + (size_t(2) << k) <= last)
+            ++k;
+        summary = mergeSummary(summary, levels[k][j >> k]);
+        j += size_t(1) << k;
+    }
+    return mergeSummary(summary, clipped(last));
+}
+
+void TimelineRenderer::buildVisibleGeometry(TimelineGeometry &geometry, const vector<TimelineRun> &runs, const TimelineStyle &style, double viewStart, double ticksPerPixel, sf::Vector2u size)
+{
+    geometry.fills.clear();
+    geometry.fills.setPrimitiveType(sf::Triangles);
+    geometry.lines.clear();
+    geometry.lines.setPrimitiveType(sf::Lines);
+    geometry.glyphs.clear();
+    geometry.glyphBuffers.clear();
+
+    const long long steps = stepCount(runs);
+    const float laneTop = viewerLaneTop;
+    const float laneHeight = style.blockHeight;
+    const float axisY = laneTop + laneHeight + 25;
+    const double viewEnd = min<double>(steps, viewStart + size.x * ticksPerPixel);
+    auto toX = [&](double tick) { return static_cast<float>((tick - viewStart) / ticksPerPixel); };
+    auto colorOf = [&](const string &label) { return label == "ID" ? sf::Color::Black : taskColors[label]; };
+
+    if (ticksPerPixel <= 1.0)
+    {
+        // every tick is at least a pixel wide: a run becomes one block, and once there is room
+        // for them every tick gets its own block with resource dots and a label
+        const double pixelsPerTick = 1.0 / ticksPerPixel;
+        const bool detailed = pixelsPerTick >= 12;
+        const long long firstTick = static_cast<long long>(viewStart);
+        const long long lastTick = min(steps, static_cast<long long>(ceil(viewEnd)));
+        size_t r = upper_bound(runStarts.begin(), runStarts.end(), firstTick) - runStarts.begin() - 1;
+        for (; r < runs.size() && runs[r].start < lastTick; ++r)
+        {
+            const TimelineRun &run = runs[r];
+            const long long from = max(firstTick, run.start);
+            const long long to = min(lastTick, run.start + run.length);
+            if (!detailed)
+            {
+                appendRect(geometry.fills, toX(from), laneTop, toX(to) - toX(from), laneHeight, colorOf(run.label));
+                continue;
+            }
+            for (long long t = from; t < to; ++t)
+            {
+                float x = toX(t);
+                appendRect(geometry.fills, x, laneTop, toX(t + 1) - x, laneHeight, colorOf(run.label));
+                int dotOffset = 0;
+                for (int id : run.resources)
+                    appendCircle(geometry.fills, x + dotOffset++ * 10, laneTop - 10, 4, resourceColors[id]);
+                if (pixelsPerTick >= 24)
+                    appendText(geometry, run.label, 12, x, laneTop + laneHeight + 2);
+            }
+        }
+    }
+    else
+    {
+        // several ticks per pixel column: the column is black for idle time with a bar of the
+        // dominant task's color whose height is the column's utilization
+        for (unsigned px = 0; px < size.x; ++px)
+        {
+            long long a = static_cast<long long>(viewStart + px * ticksPerPixel);
+            long long b = min(steps, static_cast<long long>(viewStart + (px + 1) * ticksPerPixel));
+            if (a >= steps)
+                break;
+            b = max(b, a + 1);
+
+            TimelineSummary column = summarize(runs, a, b);
+            appendRect(geometry.fills, px, laneTop, 1, laneHeight, sf::Color::Black);
+            if (column.dominant >= 0)
+            {
+                float height = laneHeight * column.busyTicks / (b - a);
+                appendRect(geometry.fills, px, laneTop + laneHeight - height, 1, height, taskColors[labels[column.dominant]]);
+            }
+        }
+    }
+
+    // time axis with about one labelled tick every 100 pixels
+    appendLine(geometry.lines, 0, axisY, size.x, axisY);
+    long long spacing = 1;
+    for (long long decade = 1; spacing / ticksPerPixel < 100; decade *= 10)
+        for (long long step : {1, 2, 5})
+            if ((spacing = step * decade) / ticksPerPixel >= 100)
+                break;
+    for (long long tick = static_cast<long long>(ceil(viewStart / spacing)) * spacing; tick <= viewEnd; tick += spacing)
+    {
+        float x = toX(tick);
+        appendLine(geometry.lines, x, axisY - 5, x, axisY + 5);
+        appendText(geometry, to_string(tick), 12, x - 5, axisY + 10);
+    }
+
+    appendText(geometry, "Ticks " + to_string(static_cast<long long>(viewStart)) + " - " + to_string(static_cast<long long>(viewEnd)) +
+                             " of " + to_string(steps) + "   wheel/+/-: zoom   drag/arrows: pan   Home: fit",
+               12, 10, 10);
+    appendLegend(geometry, axisY + 40, style);
+}
+
+// Uploads the batches to GPU vertex buffers when the driver supports them
+void TimelineRenderer::uploadGeometry(TimelineGeometry &geometry)
+{
+    geometry.uploaded = false;
+    if (!sf::VertexBuffer::isAvailable())
+        return;
+
+    auto upload = [](sf::VertexBuffer &buffer, const sf::VertexArray &vertices, sf::PrimitiveType type) {
+        buffer.setPrimitiveType(type);
+        buffer.setUsage(sf::VertexBuffer::Dynamic);
+        // recreated even when empty so a rebuilt view never draws stale vertices
+        return buffer.create(vertices.getVertexCount()) &&
+               (vertices.getVertexCount() == 0 || buffer.update(&vertices[0]));
+    };
+    geometry.uploaded = upload(geometry.fillBuffer, geometry.fills, sf::Triangles) &&
+                        upload(geometry.lineBuffer, geometry.lines, sf::Lines);
+    for (const auto &[size, glyphs] : geometry.glyphs)
+        geometry.uploaded = geometry.uploaded && upload(geometry.glyphBuffers[size], glyphs, sf::Triangles);
+}
+
+void TimelineRenderer::drawGeometry(sf::RenderTarget &target, const TimelineGeometry &geometry)
+{
+    if (geometry.uploaded)
+    {
+        target.draw(geometry.fillBuffer);
+        target.draw(geometry.lineBuffer);
+        for (const auto &[size, buffer] : geometry.glyphBuffers)
+            target.draw(buffer, sf::RenderStates(&font.getTexture(size)));
+        return;
+    }
+    target.draw(geometry.fills);
+    target.draw(geometry.lines);
+    for (const auto &[size, glyphs] : geometry.glyphs)
+        target.draw(glyphs, sf::RenderStates(&font.getTexture(size)));
+}
@@ -0,0 +1,92 @@
+// Drawing of simulated timelines, either into a window or headless into PNG files.
+#ifndef RENDER_HPP
+#define RENDER_HPP
+#include "scheduler.hpp"
+#include <SFML/Graphics.hpp>
+
+// Consecutive time units of a timeline that are drawn alike: one label holding the same resources
+struct TimelineRun
+{
+    long long start;       // first step
+    long long length;
+    string label;          // "T<id>", or "ID" when the processor is idle
+    vector<int> resources; // resources held by the running job
+};
+
+// Block geometry of the scheduler and inheritance timelines
+struct TimelineStyle
+{
+    int blockWidth;
+    int blockHeight;
+    int spacing;
+    int marginTop;
+    float legendSpacing;
+};
+
+// Batched shapes of one timeline tile: block fills, lines and the text of each font size
+struct TimelineGeometry
+{
+    sf::VertexArray fills;
+    sf::VertexArray lines;
+    map<unsigned, sf::VertexArray> glyphs;
+
+    bool uploaded = false;
+    sf::VertexBuffer fillBuffer;
+    sf::VertexBuffer lineBuffer;
+    map<unsigned, sf::VertexBuffer> glyphBuffers;
+};
+
+// Level-of-detail summary of a span of ticks
+struct TimelineSummary
+{
+    int dominant;      // label index that runs the most in the span, -1 when idle throughout
+    long long dominantTicks;
+    long long busyTicks;
+};
+
+// The runs in step order. A Scheduler step is a tick; Inheritance only has steps for the ticks a
+// job ran, like its timeline.
+vector<TimelineRun> timelineRuns(const Scheduler &scheduler);
+vector<TimelineRun> timelineRuns(const Inheritance &inheritance);
+
+// Keeps the font and the offscreen texture between calls, so one renderer can be
+// reused to write the timelines of a whole batch of simulations.
+class TimelineRenderer
+{
+public:
+    TimelineRenderer();
+    bool isReady() const;
+
+    void display(const Scheduler &scheduler);
+    void display(const Inheritance &inheritance);
+    // Writes <prefix>_<n>.png tiles of at most stepsPerImage steps, returns how many were written
+    int renderToPNG(const Scheduler &scheduler, const string &prefix, int stepsPerImage = 1000);
+    int renderToPNG(const Inheritance &inheritance, const string &prefix, int stepsPerImage = 1000);
+
+private:
+    void display(const vector<TimelineRun> &runs, const TimelineStyle &style, const string &title);
+    int renderToPNG(const vector<TimelineRun> &runs, const TimelineStyle &style, const string &prefix, int stepsPerImage);
+    void buildGeometry(TimelineGeometry &geometry, const vector<TimelineRun> &runs, long long first, long long count, const TimelineStyle &style);
+    void appendText(TimelineGeometry &geometry, const string &text, unsigned size, float x, float y);
+    void appendLegend(TimelineGeometry &geometry, float legendStartY, const TimelineStyle &style);
+    void buildLevels(const vector<TimelineRun> &runs);
+    // Summary of ticks [a, b), from the clipped runs at either end and the levels in between
+    TimelineSummary summarize(const vector<TimelineRun> &runs, long long a, long long b) const;
+    void buildVisibleGeometry(TimelineGeometry &geometry, const vector<TimelineRun> &runs, const TimelineStyle &style, double viewStart, double ticksPerPixel, sf::Vector2u size);
+    void uploadGeometry(TimelineGeometry &geometry);
+    void drawGeometry(sf::RenderTarget &target, const TimelineGeometry &geometry);
+    sf::Vector2u imageSize(long long count, const TimelineStyle &style) const;
+    void assignColors(const vector<TimelineRun> &runs);
+
+    sf::Font font;
+    bool fontLoaded;
+    sf::RenderTexture texture;
+    sf::Vector2u textureSize;
+    map<string, sf::Color> taskColors;
+    map<int, sf::Color> resourceColors;
+    vector<string> labels;                  // distinct task labels indexed by the summaries
+    vector<long long> runStarts;            // start of every run, for the binary searches
+    vector<vector<TimelineSummary>> levels; // levels[k][j] summarizes runs [j << k, (j + 1) << k)
+};
+
+#endif // RENDER_HPP
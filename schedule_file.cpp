@@ -0,0 +1,267 @@
+#include "schedule_file.hpp"
+#include <cstring>
+
+static const char scheduleMagic[8] = {'S', 'C', 'H', 'E', 'D', 'U', 'L', 'E'};
+static const uint32_t scheduleVersion = 1;
+static const size_t pendingIntervals = 4096;
+static const size_t runsPerFlush = 512;
+
+static void seekTo(FILE *file, uint64_t offset)
+{
+#ifdef _WIN32
+    int failed = _fseeki64(file, static_cast<long long>(offset), SEEK_SET);
+#else
+    int failed = fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    if (failed)
+        throw runtime_error("Failed to seek in schedule file");
+}
+
+static void writeAll(FILE *file, const void *data, size_t size)
+{
+    if (size > 0 && fwrite(data, 1, size, file) != size)
+        throw runtime_error("Failed to write schedule file");
+}
+
+ScheduleFileWriter::ScheduleFileWriter(const string &path, const vector<ScheduleFileTask> &tasks)
+    : file(fopen(path.c_str(), "w+b")), header(), tasks(tasks)
+{
+    if (!file)
+        throw runtime_error("Cannot open " + path);
+    // the magic is only filled in by finish(), so an unfinished file is never mistaken for a schedule
+    header.version = scheduleVersion;
+    header.taskCount = static_cast<uint32_t>(tasks.size());
+    header.indexStride = indexStride;
+    header.taskTableOffset = sizeof(ScheduleFileHeader);
+    header.intervalOffset = header.taskTableOffset + tasks.size() * sizeof(ScheduleFileTask);
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        taskIndex[tasks[i].id] = i;
+        this->tasks[i].firstRun = 0;
+        this->tasks[i].runCount = 0;
+    }
+    pending.reserve(pendingIntervals);
+    writeAll(file, &header, sizeof(header));
+    writeAll(file, this->tasks.data(), this->tasks.size() * sizeof(ScheduleFileTask));
+}
+
+ScheduleFileWriter::~ScheduleFileWriter()
+{
+    if (file)
+        fclose(file);
+}
+
+void ScheduleFileWriter::push(const TimelineInterval &interval)
+{
+    if (interval.length <= 0)
+        return;
+    if (header.intervalCount % indexStride == 0)
+        index.push_back(interval.start);
+    auto it = taskIndex.find(interval.taskId);
+    if (it != taskIndex.end())
+        tasks[it->second].runCount++;
+    pending.push_back({interval.start, interval.length, interval.taskId, 0});
+    header.intervalCount++;
+    end = interval.start + interval.length;
+    if (pending.size() == pendingIntervals)
+        flushIntervals();
+}
+
+void ScheduleFileWriter::flushIntervals()
+{
+    writeAll(file, pending.data(), pending.size() * sizeof(ScheduleFileInterval));
+    pending.clear();
+}
+
+// Reads the intervals back in order and scatters their positions into each task's run list,
+// a few hundred positions per task at a time
+void ScheduleFileWriter::writeTaskRuns()
+{
+    vector<vector<uint64_t>> runs(tasks.size());
+    vector<uint64_t> written(tasks.size(), 0);
+    auto flushRuns = [&](size_t row) {
+        seekTo(file, header.taskRunsOffset + (tasks[row].firstRun + written[row]) * sizeof(uint64_t));
+        writeAll(file, runs[row].data(), runs[row].size() * sizeof(uint64_t));
+        written[row] += runs[row].size();
+        runs[row].clear();
+    };
+
+    for (uint64_t first = 0; first < header.intervalCount; first += pendingIntervals)
+    {
+        size_t count = static_cast<size_t>(min<uint64_t>(pendingIntervals, header.intervalCount - first));
+        pending.resize(count);
+        seekTo(file, header.intervalOffset + first * sizeof(ScheduleFileInterval));
+        if (fread(pending.data(), sizeof(ScheduleFileInterval), count, file) != count)
+            throw runtime_error("Failed to read back schedule file");
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto it = taskIndex.find(pending[i].taskId);
+            if (it == taskIndex.end())
+                continue;
+            runs[it->second].push_back(first + i);
+            if (runs[it->second].size() == runsPerFlush)
+                flushRuns(it->second);
+        }
+    }
+    pending.clear();
+    for (size_t row = 0; row < tasks.size(); ++row)
+        flushRuns(row);
+}
+
+void ScheduleFileWriter::finish()
+{
+    if (!file)
+        return;
+    flushIntervals();
+
+    header.horizon = end;
+    header.indexCount = index.size();
+    header.indexOffset = header.intervalOffset + header.intervalCount * sizeof(ScheduleFileInterval);
+    header.taskRunsOffset = header.indexOffset + header.indexCount * sizeof(int64_t);
+    writeAll(file, index.data(), index.size() * sizeof(int64_t));
+    uint64_t firstRun = 0;
+    for (auto &task : tasks)
+    {
+        task.firstRun = firstRun;
+        firstRun += task.runCount;
+    }
+    writeTaskRuns();
+
+    memcpy(header.magic, scheduleMagic, sizeof(scheduleMagic));
+    seekTo(file, 0);
+    writeAll(file, &header, sizeof(header));
+    writeAll(file, tasks.data(), tasks.size() * sizeof(ScheduleFileTask));
+    int closed = fclose(file);
+    file = nullptr;
+    if (closed != 0)
+        throw runtime_error("Failed to write schedule file");
+}
+
+void writeScheduleFile(Scheduler &scheduler, const string &path, long long horizon)
+{
+    vector<ScheduleFileTask> tasks;
+    for (const auto &task : scheduler.tasks_)
+        tasks.push_back({task.id, task.priority, task.WCET, task.period, task.deadline, 0, 0});
+    ScheduleFileWriter writer(path, tasks);
+    scheduler.generateTimeline(writer, horizon);
+}
+
+void writeScheduleFile(const Inheritance &inheritance, const string &path)
+{
+    vector<ScheduleFileTask> tasks;
+    for (const auto &job : inheritance.getJobTemplates())
+        tasks.push_back({job.id, job.basePriority, job.WCET, job.period, job.deadline, 0, 0});
+    ScheduleFileWriter writer(path, tasks);
+
+    TimelineInterval run = {IDLE_TASK, 0, 0};
+    auto extend = [&](int taskId, long long time, long long length) {
+        if (taskId != run.taskId && run.length > 0)
+        {
+            writer.push(run);
+            run = {taskId, time, 0};
+        }
+        run.taskId = taskId;
+        run.length += length;
+    };
+    long long time = 0;
+    for (const auto &entry : inheritance.getTimeline())
+    {
+        if (entry.time > time)
+            extend(IDLE_TASK, time, entry.time - time);
+        extend(entry.jobId, entry.time, 1);
+        time = entry.time + 1;
+    }
+    if (inheritance.getHorizon() > time)
+        extend(IDLE_TASK, time, inheritance.getHorizon() - time);
+    if (run.length > 0)
+        writer.push(run);
+    writer.finish();
+}
+
+ScheduleFile::ScheduleFile(const string &path) : file(path)
+{
+    const char *data = file.data();
+    size_t size = file.size();
+    auto fits = [&](uint64_t offset, uint64_t count, size_t recordSize) {
+        return offset % 8 == 0 && offset <= size && count <= (size - offset) / recordSize;
+    };
+    header = reinterpret_cast<const ScheduleFileHeader *>(data);
+    if (!data || size < sizeof(ScheduleFileHeader) || memcmp(header->magic, scheduleMagic, sizeof(scheduleMagic)) != 0 ||
+        header->version != scheduleVersion || header->indexStride == 0 ||
+        !fits(header->taskTableOffset, header->taskCount, sizeof(ScheduleFileTask)) ||
+        !fits(header->intervalOffset, header->intervalCount, sizeof(ScheduleFileInterval)) ||
+        !fits(header->indexOffset, header->indexCount, sizeof(int64_t)) ||
+        header->indexCount != (header->intervalCount + header->indexStride - 1) / header->indexStride)
+        throw runtime_error("Invalid schedule file " + path);
+    tasks = reinterpret_cast<const ScheduleFileTask *>(data + header->taskTableOffset);
+    intervals = reinterpret_cast<const ScheduleFileInterval *>(data + header->intervalOffset);
+    index = reinterpret_cast<const int64_t *>(data + header->indexOffset);
+    taskRuns = reinterpret_cast<const uint64_t *>(data + header->taskRunsOffset);
+    uint64_t runCount = 0;
+    for (size_t i = 0; i < header->taskCount; ++i)
+        runCount += tasks[i].runCount;
+    if (!fits(header->taskRunsOffset, runCount, sizeof(uint64_t)))
+        throw runtime_error("Invalid schedule file " + path);
+}
+
+long long ScheduleFile::getHorizon() const
+{
+    return header->horizon;
+}
+
+size_t ScheduleFile::getTaskCount() const
+{
+    return header->taskCount;
+}
+
+const ScheduleFileTask &ScheduleFile::getTask(size_t i) const
+{
+    if (i >= header->taskCount)
+        throw runtime_error("Invalid Task index");
+    return tasks[i];
+}
+
+size_t ScheduleFile::getIntervalCount() const
+{
+    return static_cast<size_t>(header->intervalCount);
+}
+
+const ScheduleFileInterval &ScheduleFile::getInterval(size_t i) const
+{
+    if (i >= header->intervalCount)
+        throw runtime_error("Invalid interval index");
+    return intervals[i];
+}
+
+int ScheduleFile::taskAt(long long time) const
+{
+    // the last indexed block starting at or before time, then the last interval in it that does
+    const int64_t *block = upper_bound(index, index + header->indexCount, time);
+    if (block == index)
+        return IDLE_TASK;
+    uint64_t first = (block - index - 1) * header->indexStride;
+    uint64_t last = min(first + header->indexStride, header->intervalCount);
+    const ScheduleFileInterval *it = upper_bound(intervals + first, intervals + last, time,
+                                                 [](long long t, const ScheduleFileInterval &interval) { return t < interval.start; });
+    --it;
+    return time < it->start + it->length ? it->taskId : IDLE_TASK;
+}
+
+vector<TimelineInterval> ScheduleFile::intervalsOf(int taskId) const
+{
+    vector<TimelineInterval> result;
+    for (size_t i = 0; i < header->taskCount; ++i)
+    {
+        if (tasks[i].id != taskId)
+            continue;
+        result.reserve(tasks[i].runCount);
+        for (uint64_t k = 0; k < tasks[i].runCount; ++k)
+        {
+            uint64_t position = taskRuns[tasks[i].firstRun + k];
+            if (position < header->intervalCount)
+                result.push_back({intervals[position].taskId, intervals[position].start, intervals[position].length});
+        }
+        return result;
+    }
+    throw runtime_error("Invalid Task ID");
+}
@@ -0,0 +1,105 @@
+// On-disk schedule format, laid out so a memory-mapped file is used as is with no parsing:
+//
+//   header | task table | intervals sorted by start | time index | per-task run lists
+//
+// Every section is an array of the fixed-size little-endian records below, 8-byte aligned.
+// The time index holds the start of every indexStride-th interval, so finding what runs at
+// time t is a binary search of the index and then of one block. Each task's run list holds
+// the positions of its intervals, so scanning one task only touches that task's pages.
+#ifndef SCHEDULE_FILE_HPP
+#define SCHEDULE_FILE_HPP
+#include "timeline_sink.hpp"
+#include "mapped_file.hpp"
+#include <cstdint>
+
+struct ScheduleFileHeader
+{
+    char magic[8]; // "SCHEDULE"
+    uint32_t version;
+    uint32_t taskCount;
+    uint64_t intervalCount;
+    uint64_t indexCount;
+    uint64_t indexStride;
+    int64_t horizon;
+    uint64_t taskTableOffset;
+    uint64_t intervalOffset;
+    uint64_t indexOffset;
+    uint64_t taskRunsOffset;
+};
+
+struct ScheduleFileTask
+{
+    int32_t id;
+    int32_t priority;
+    int64_t WCET;
+    int64_t period;
+    int64_t deadline;
+    uint64_t firstRun; // position of the task's run list in the run lists section
+    uint64_t runCount;
+};
+
+struct ScheduleFileInterval
+{
+    int64_t start;
+    int64_t length;
+    int32_t taskId; // IDLE_TASK when the processor is idle
+    uint32_t reserved;
+};
+
+// Streams intervals to the file as they are pushed, holding only the sparse time index and
+// a bounded buffer per task in memory. The run lists and header are written by finish().
+class ScheduleFileWriter : public TimelineSink
+{
+public:
+    ScheduleFileWriter(const string &path, const vector<ScheduleFileTask> &tasks);
+    ~ScheduleFileWriter();
+    void push(const TimelineInterval &interval) override;
+    void finish() override;
+
+    static const uint64_t indexStride = 1024;
+
+private:
+    void flushIntervals();
+    void writeTaskRuns();
+
+    FILE *file;
+    ScheduleFileHeader header;
+    vector<ScheduleFileTask> tasks;
+    unordered_map<int, size_t> taskIndex; // task id -> row in tasks
+    vector<ScheduleFileInterval> pending;
+    vector<int64_t> index;
+    int64_t end = 0;
+};
+
+// Writes a Scheduler simulation over horizon ticks (one hyperperiod when 0)
+void writeScheduleFile(Scheduler &scheduler, const string &path, long long horizon = 0);
+// Writes the timeline Inheritance has recorded; ticks without an entry are idle
+void writeScheduleFile(const Inheritance &inheritance, const string &path);
+
+// Read-only view of a schedule file, mapped into memory for the lifetime of the object
+class ScheduleFile
+{
+public:
+    explicit ScheduleFile(const string &path);
+
+    long long getHorizon() const;
+    size_t getTaskCount() const;
+    const ScheduleFileTask &getTask(size_t i) const;
+    size_t getIntervalCount() const;
+    const ScheduleFileInterval &getInterval(size_t i) const;
+
+    // Id of the task running at time, IDLE_TASK when idle or outside the schedule
+    int taskAt(long long time) const;
+    // Every interval the task ran, in time order
+    vector<TimelineInterval> intervalsOf(int taskId) const;
+
+private:
+    MappedFile file;
+    const ScheduleFileHeader *header = nullptr;
+    const ScheduleFileTask *tasks = nullptr;
+    const ScheduleFileInterval *intervals = nullptr;
+    const int64_t *index = nullptr;
+    const uint64_t *taskRuns = nullptr;
+};
+
+#endif // SCHEDULE_FILE_HPP
@@ -3,8 +3,13 @@
 #include <algorithm>
 
 //graphics
-#include <SFML/Graphics.hpp>
-#include <filesystem> 
+#include "render.hpp"
+#include "trace.hpp"
+#include "timeline_sink.hpp"
+#include "instrumentation.hpp"
+#include <fstream>
+#include <thread>
+#include <atomic>
 
 
 using namespace std;
@@ -26,6 +31,31 @@ double Scheduler::computeUtilization() const
     return utilization;
 }
 
+void UtilizationSum::add(long long WCET, long long period)
+{
+    approximate_ += static_cast<long double>(WCET) / period;
+    if (!exact_ || exceeded_)
+        return;
+    // numerator_ < denominator_ <= INT_MAX here, so the products below stay within 62 bits
+    long long common = denominator_ / gcd(denominator_, period) * period;
+    if (common > INT_MAX)
+    {
+        exact_ = false;
+        return;
+    }
+    numerator_ = numerator_ * (common / denominator_) + WCET * (common / period);
+    denominator_ = common;
+    // the terms are positive, so the sum stays above 1 from here on
+    exceeded_ = numerator_ > denominator_;
+}
+
+bool UtilizationSum::exceedsOne() const
+{
+    if (exceeded_)
+        return true;
+    return exact_ ? false : approximate_ > 1.0L;
+}
+
 int Scheduler::computeHyperperiod() const
 {
     int h = 1;
@@ -38,56 +68,139 @@ int Scheduler::computeHyperperiod() const
 
 void Scheduler::setPriority()
 {
-    int numTasks = tasks_.size();
-    int assigned = 0;
-    int priority = tasks_.size();
+    setPriority(choice_ == CHOICE_RM ? ORDER_RATE_MONOTONIC : ORDER_DEADLINE_MONOTONIC);
+}
 
-    while (assigned < numTasks)
-    {
-        int shortestValue = INT_MAX;
-        int shortestIndex = -1;
+// beyond this many tasks only a summary of the assignment is printed
+static const size_t maxListedPriorities = 64;
 
-        for (size_t i = 0; i < tasks_.size(); ++i)
+void Scheduler::setPriority(int order)
+{
+    // true when a comes before b, i.e. gets the higher priority; ties fall through to a second
+    // key and then to the task id, so the result does not depend on the input order
+    auto before = [order](const Task &a, const Task &b) {
+        switch (order)
         {
-            if (tasks_[i].priority != 0)
-                continue;
-
-            int compareValue = (choice_ == CHOICE_RM) ? tasks_[i].period : tasks_[i].deadline;
-            if (compareValue < shortestValue)
-            {
-                shortestValue = compareValue;
-                shortestIndex = i;
-            }
-        }
-
-        if (shortestIndex != -1)
+        case ORDER_RATE_MONOTONIC:
+            if (a.period != b.period)
+                return a.period < b.period;
+            if (a.deadline != b.deadline)
+                return a.deadline < b.deadline;
+            break;
+        case ORDER_DEADLINE_MONOTONIC:
+            if (a.deadline != b.deadline)
+                return a.deadline < b.deadline;
+            if (a.period != b.period)
+                return a.period < b.period;
+            break;
+        case ORDER_SLACK_MONOTONIC:
+            if (a.deadline - a.WCET != b.deadline - b.WCET)
+                return a.deadline - a.WCET < b.deadline - b.WCET;
+            if (a.deadline != b.deadline)
+                return a.deadline < b.deadline;
+            break;
+        case ORDER_UTILIZATION:
         {
-            tasks_[shortestIndex].priority = priority--;
-            assigned++;
+            // higher C/T first, compared without division
+            long long left = static_cast<long long>(a.WCET) * b.period;
+            long long right = static_cast<long long>(b.WCET) * a.period;
+            if (left != right)
+                return left > right;
+            if (a.period != b.period)
+                return a.period < b.period;
+            break;
         }
-        else
-        {
-            std::cerr << "Error: No unassigned tasks found in priority assignment.\n";
+        case ORDER_SHORTEST_WCET:
+            if (a.WCET != b.WCET)
+                return a.WCET < b.WCET;
+            if (a.period != b.period)
+                return a.period < b.period;
             break;
         }
-    }
+        return a.id < b.id;
+    };
+    if (order < ORDER_RATE_MONOTONIC || order > ORDER_SHORTEST_WCET)
+        throw runtime_error("Invalid priority order " + to_string(order));
+
+    vector<size_t> ranked(tasks_.size());
+    iota(ranked.begin(), ranked.end(), 0);
+    stable_sort(ranked.begin(), ranked.end(), [&](size_t a, size_t b) { return before(tasks_[a], tasks_[b]); });
+    const int numTasks = tasks_.size();
+    for (int rank = 0; rank < numTasks; ++rank)
+        tasks_[ranked[rank]].priority = numTasks - rank;
 
+    if (tasks_.size() > maxListedPriorities)
+    {
+        cout << "Assigned priorities 1 to " << numTasks << " to " << numTasks << " tasks\n";
+        return;
+    }
     for (const auto &task : tasks_)
     {
         std::cout << "Task " << task.id << " has priority " << task.priority << '\n';
     }
 }
 
+// Lehoczky's analysis for arbitrary deadlines: job q of the level-i busy period finishes at the
+// smallest w with w = (q + 1) * C_i + sum over higher priority j of ceil(w / T_j) * C_j, and its
+// response time is w - q * T_i. The busy period closes at the first job with w <= (q + 1) * T_i.
+long long Scheduler::computeResponseTime(const Task &task, const std::vector<Task> &higher, long long limit) const
+{
+    UtilizationSum utilization;
+    utilization.add(task.WCET, task.period);
+    for (const auto &other : higher)
+        utilization.add(other.WCET, other.period);
+    // the busy period never closes when the level is overloaded
+    if (utilization.exceedsOne())
+        return LLONG_MAX;
+
+    long long worst = 0;
+    long long w = task.WCET;
+    long long iterations = 0;
+    for (long long q = 0;; ++q)
+    {
+        // w of the previous job is a lower bound for this one, so iterate on from there
+        w = max(w, (q + 1) * task.WCET);
+        while (true)
+        {
+            ++iterations;
+            long long next = (q + 1) * task.WCET;
+            for (const auto &other : higher)
+                next += (w + other.period - 1) / other.period * other.WCET;
+            if (next == w)
+                break;
+            w = next;
+        }
+        worst = max(worst, w - q * task.period);
+        if (worst > limit || w <= (q + 1) * task.period)
+        {
+            INSTRUMENT_TASK_ITERATIONS(task.id, iterations);
+            return worst;
+        }
+    }
+}
+
 bool Scheduler::runRMDMTest(std::vector<Task> taskSet)
 {
+    INSTRUMENT_PHASE(PHASE_ANALYZE);
     if (choice_ == CHOICE_RM || choice_ == CHOICE_DM) {
         setPriority();
+        // the caller's copy may predate the priorities just assigned
+        for (auto &task : taskSet)
+        {
+            for (const auto &assigned : tasks_)
+            {
+                if (assigned.id == task.id)
+                    task.priority = assigned.priority;
+            }
+        }
     }
     cout << "\nRunning RM/DM schedulability tests...\n";
     double utilization = computeUtilization();
     double bound = taskSet.size() * (pow(2, 1.0 / taskSet.size()) - 1);
+    bool constrainedDeadlines = all_of(taskSet.begin(), taskSet.end(), [](const Task &task) { return task.deadline <= task.period; });
 
-    if (utilization <= bound)
+    // the sum is of C / D, which only bounds the load from above when no deadline exceeds its period
+    if (utilization <= bound && constrainedDeadlines)
     {
         cout << "Schedulable: " << utilization << " <= " << bound << endl;
         return true;
@@ -101,28 +214,13 @@ bool Scheduler::runRMDMTest(std::vector<Task> taskSet)
     bool schedulable = true;
     for (const auto &task : taskSet)
     {
-        cout << "Task " << task.id << " response time analysis:" << endl;
-        int previousTime = 0;
-        int responseTime = task.WCET;
-        int constantTime = 0;
-        while (previousTime <= task.deadline)
+        vector<Task> higher;
+        for (const auto &otherTask : taskSet)
         {
-            constantTime = responseTime;
-            responseTime = task.WCET;
-            cout << "Task " << task.id << " response time:";
-            for (const auto &otherTask : taskSet)
-            {
-                if (otherTask.id != task.id && otherTask.deadline <= task.deadline)
-                {
-                    cout << " ceil(" << constantTime << " / " << otherTask.period << ") * " << otherTask.WCET;
-                    responseTime += ceil(static_cast<double>(constantTime) / otherTask.period) * otherTask.WCET;
-                }
-            }
-            cout << " = " << responseTime << endl;
-            if (previousTime == responseTime)
-                break;
-            previousTime = responseTime;
+            if (otherTask.id != task.id && otherTask.priority >= task.priority)
+                higher.push_back(otherTask);
         }
+        long long responseTime = computeResponseTime(task, higher);
         if (responseTime > task.deadline)
         {
             cout << "Task " << task.id << " is not schedulable. \n\n";
@@ -139,8 +237,10 @@ bool Scheduler::runRMDMTest(std::vector<Task> taskSet)
 
 bool Scheduler::runEDFLSTTest()
 {
+    INSTRUMENT_PHASE(PHASE_ANALYZE);
     cout << "\nRunning EDF/LST schedulability test...\n";
     double utilization = 0.0;
+    UtilizationSum density;
     bool usesDeadline = false;
     int hyper = computeHyperperiod();
     vector<int> L;
@@ -148,13 +248,14 @@ bool Scheduler::runEDFLSTTest()
     for (const auto &task : tasks_)
     {
         utilization += static_cast<double>(task.WCET) / task.deadline;
+        density.add(task.WCET, task.deadline);
         if (task.deadline < task.period)
         {
             usesDeadline = true;
         }
     }
 
-    if (utilization <= 1.0)
+    if (!density.exceedsOne())
     {
         cout << "Schedulable: " << utilization << " <= 1\n";
         return true;
@@ -184,6 +285,7 @@ bool Scheduler::runEDFLSTTest()
     sort(L.begin(), L.end());
     for (const auto &l : L)
     {
+        INSTRUMENT_COUNT(COUNTER_PDC_POINTS, 1);
         int demand = 0;
         for (const auto &task : tasks_)
         {
@@ -204,418 +306,994 @@ bool Scheduler::runEDFLSTTest()
     return true;
 }
 
-void Scheduler::generateTimeline()
+// Appends the intervals to a timeline owned by someone else
+class AppendingSink : public TimelineSink
 {
-    int hyperperiod = computeHyperperiod();
-    vector<int> remaining(tasks_.size(), 0);
-    vector<int> nextRelease(tasks_.size(), 0);
-    vector<int> nextDeadline(tasks_.size(), 0);
+public:
+    explicit AppendingSink(vector<TimelineInterval> &timeline) : timeline(timeline) {}
+
+    void push(const TimelineInterval &interval) override
+    {
+        timeline.push_back(interval);
+    }
 
-    std::cout << "\nTimeline (0 to " << hyperperiod << "):\n";
+private:
+    vector<TimelineInterval> &timeline;
+};
 
-    for (int t = 0; t < hyperperiod; ++t)
+// A segment of a parallel simulation, whose job events are held back with its runs until
+// the segments are stitched in time order
+class SegmentSink : public AppendingSink
+{
+public:
+    explicit SegmentSink(vector<TimelineInterval> &timeline) : AppendingSink(timeline) {}
+
+    void release(int taskId, long long time) override
     {
-        // Release tasks
-        for (size_t i = 0; i < tasks_.size(); ++i)
+        events.push_back({taskId, time, true, false});
+    }
+
+    void deadline(int taskId, long long time, bool met) override
+    {
+        events.push_back({taskId, time, false, met});
+    }
+
+    // Passes the job events on in the order the segment reported them
+    void replay(TimelineSink &sink) const
+    {
+        for (const auto &event : events)
         {
-            if (t == nextRelease[i])
-            {
-                remaining[i] += tasks_[i].WCET;
-                nextDeadline[i] = tasks_[i].deadline + nextRelease[i];
-                nextRelease[i] += tasks_[i].period;
-            }
+            if (event.release)
+                sink.release(event.taskId, event.time);
+            else
+                sink.deadline(event.taskId, event.time, event.met);
         }
-        int runningTask = -1;
-        static int previousTask = -1;
-        int priority = 0;
-        int minDeadline = INT_MAX;
-        int minSlack = INT_MAX;
+    }
+
+private:
+    struct JobEvent
+    {
+        int taskId;
+        long long time;
+        bool release;
+        bool met;
+    };
+    vector<JobEvent> events;
+};
+
+void Scheduler::setMissPolicy(int policy, bool stopAtFirstMiss)
+{
+    if (policy != MISS_CONTINUE && policy != MISS_ABORT && policy != MISS_SKIP_NEXT)
+        throw runtime_error("Invalid deadline miss policy " + to_string(policy));
+    missPolicy_ = policy;
+    stopAtFirstMiss_ = stopAtFirstMiss;
+}
+
+const vector<DeadlineMiss> &Scheduler::getDeadlineMisses() const
+{
+    return misses_;
+}
+
+const vector<JobRecord> &Scheduler::getJobs() const
+{
+    return jobs_;
+}
+
+long long Scheduler::getPreemptionCount() const
+{
+    return preemptions_;
+}
+
+const vector<ResponseStatistics> &Scheduler::getResponseStatistics() const
+{
+    return responses_;
+}
+
+ResponseStatistics::ResponseStatistics(long long bucketWidth)
+    : bucketWidth(max(1LL, bucketWidth)), histogram(RESPONSE_BUCKETS, 0) {}
+
+void ResponseStatistics::add(long long response, long long startDelay)
+{
+    if (jobs == 0)
+    {
+        minimum = maximum = response;
+        minStartDelay = maxStartDelay = startDelay;
+    }
+    minimum = min(minimum, response);
+    maximum = max(maximum, response);
+    minStartDelay = min(minStartDelay, startDelay);
+    maxStartDelay = max(maxStartDelay, startDelay);
+    total += response;
+    jobs++;
+    histogram[min<long long>(response / bucketWidth, RESPONSE_BUCKETS - 1)]++;
+}
+
+void ResponseStatistics::merge(const ResponseStatistics &other)
+{
+    if (other.jobs == 0)
+        return;
+    if (jobs == 0)
+    {
+        *this = other;
+        return;
+    }
+    minimum = min(minimum, other.minimum);
+    maximum = max(maximum, other.maximum);
+    minStartDelay = min(minStartDelay, other.minStartDelay);
+    maxStartDelay = max(maxStartDelay, other.maxStartDelay);
+    total += other.total;
+    jobs += other.jobs;
+    for (int b = 0; b < RESPONSE_BUCKETS; ++b)
+        histogram[b] += other.histogram[b];
+}
+
+double ResponseStatistics::mean() const
+{
+    return jobs == 0 ? 0.0 : static_cast<double>(total) / jobs;
+}
+
+long long ResponseStatistics::percentile(double fraction) const
+{
+    if (jobs == 0)
+        return 0;
+    // nearest rank: the bucket holding the ceil(fraction * jobs)-th smallest response
+    long long rank = max(1LL, static_cast<long long>(ceil(fraction * jobs)));
+    long long seen = 0;
+    for (int b = 0; b < RESPONSE_BUCKETS; ++b)
+    {
+        seen += histogram[b];
+        // the last bucket has no upper edge, only the largest response bounds it
+        if (seen >= rank && b == RESPONSE_BUCKETS - 1)
+            return maximum;
+        if (seen >= rank)
+            return max(minimum, min(maximum, (b + 1) * bucketWidth - 1));
+    }
+    return maximum;
+}
+
+long long ResponseStatistics::startJitter() const
+{
+    return maxStartDelay - minStartDelay;
+}
+
+long long Scheduler::computeResponseBound(const Task &task) const
+{
+    if (choice_ == CHOICE_EDF || choice_ == CHOICE_LST)
+        return -1;
+    vector<Task> higher;
+    for (const auto &other : tasks_)
+    {
+        if (other.id != task.id && other.priority >= task.priority)
+            higher.push_back(other);
+    }
+    return computeResponseTime(task, higher);
+}
+
+void Scheduler::displayResponseStatistics(ostream &out) const
+{
+    out << "\nObserved response times:\n";
+    out << left << setw(6) << "Task" << setw(8) << "Jobs" << setw(8) << "Min" << setw(10) << "Mean" << setw(8) << "P99"
+        << setw(8) << "Max" << setw(8) << "Jitter" << setw(8) << "Bound" << "Max/Bound\n";
+    for (size_t i = 0; i < tasks_.size() && i < responses_.size(); ++i)
+    {
+        const ResponseStatistics &stats = responses_[i];
+        long long bound = computeResponseBound(tasks_[i]);
+        out << left << setw(6) << ("T" + to_string(tasks_[i].id)) << setw(8) << stats.jobs << setw(8) << stats.minimum
+            << setw(10) << fixed << setprecision(2) << stats.mean() << setw(8) << stats.percentile(0.99) << setw(8)
+            << stats.maximum << setw(8) << stats.startJitter();
+        if (bound < 0)
+            out << "-\n";
+        else if (bound == LLONG_MAX)
+            out << setw(8) << "inf" << "-\n";
+        else
+            out << setw(8) << bound << static_cast<double>(stats.maximum) / bound << "\n";
+        out.unsetf(ios::floatfield);
+        out << setprecision(6);
+    }
+    out << right;
+}
+
+bool Scheduler::generateTimeline(long long horizon)
+{
+    timeline.clear();
+    AppendingSink sink(timeline);
+    return simulate(sink, horizon, true);
+}
+
+bool Scheduler::generateTimeline(TimelineSink &sink, long long horizon)
+{
+    return simulate(sink, horizon, false);
+}
+
+bool Scheduler::simulate(TimelineSink &sink, long long horizon, bool recordsJobs)
+{
+    INSTRUMENT_PHASE(PHASE_SIMULATE);
+    if (horizon == 0)
+        horizon = computeHyperperiod();
+    if (threads_ > 1 && missPolicy_ == MISS_CONTINUE && !stopAtFirstMiss_)
+    {
+        generateInParallel(sink, horizon, recordsJobs);
+        return misses_.empty();
+    }
+    SimulationState state = startSimulation(recordsJobs);
+    advance(state, horizon, sink);
+    finishSimulation(state, sink);
+    return misses_.empty();
+}
+
+void Scheduler::setThreadCount(int threads)
+{
+    if (threads < 1)
+        throw runtime_error("Invalid thread count " + to_string(threads));
+    threads_ = threads;
+}
+
+// Work released by task in [begin, end)
+static long long demand(const Task &task, long long begin, long long end)
+{
+    auto releasesBefore = [&](long long t) { return (t + task.period - 1) / task.period; };
+    return (releasesBefore(end) - releasesBefore(begin)) * task.WCET;
+}
+
+vector<long long> Scheduler::computeIdleInstants(long long horizon) const
+{
+    vector<long long> idle;
+    long long start = 0; // a release instant with nothing pending
+    while (start < horizon)
+    {
+        // the busy period from start ends once the work released in it has been done
+        long long end = start + 1;
+        while (end < horizon)
+        {
+            long long work = 0;
+            for (const auto &task : tasks_)
+                work += demand(task, start, end);
+            if (start + work == end)
+                break;
+            end = start + work;
+        }
+        if (end >= horizon)
+            break;
+        idle.push_back(end);
+        start = LLONG_MAX;
+        for (const auto &task : tasks_)
+            start = min(start, (end + task.period - 1) / task.period * task.period);
+    }
+    return idle;
+}
+
+void Scheduler::generateInParallel(TimelineSink &sink, long long horizon, bool recordsJobs)
+{
+    // cut at the idle instants closest after evenly spaced targets; a few pieces per thread
+    // even out busy and quiet stretches
+    vector<long long> idle = computeIdleInstants(horizon);
+    const long long pieces = 4 * threads_;
+    vector<long long> cuts = {0};
+    auto next = idle.begin();
+    for (long long k = 1; k < pieces; ++k)
+    {
+        next = lower_bound(next, idle.end(), k * horizon / pieces);
+        if (next == idle.end())
+            break;
+        if (*next > cuts.back())
+            cuts.push_back(*next);
+    }
+    cuts.push_back(horizon);
+
+    const size_t segments = cuts.size() - 1;
+    vector<vector<TimelineInterval>> intervals(segments);
+    vector<SegmentSink> segmentSinks;
+    for (size_t k = 0; k < segments; ++k)
+        segmentSinks.emplace_back(intervals[k]);
+    vector<vector<DeadlineMiss>> misses(segments);
+    vector<vector<JobRecord>> jobs(segments);
+    vector<long long> preemptions(segments);
+    vector<vector<ResponseStatistics>> responses(segments);
+    atomic<size_t> nextSegment(0);
+    auto simulateSegments = [&]() {
+        for (size_t k = nextSegment++; k < segments; k = nextSegment++)
+        {
+            // nothing is pending at a cut, so a segment starts like time 0 does
+            SimulationState state = startSimulation(recordsJobs);
+            state.time = cuts[k];
+            state.run.start = cuts[k];
+            for (size_t i = 0; i < tasks_.size(); ++i)
+                state.nextRelease[i] = (cuts[k] + tasks_[i].period - 1) / tasks_[i].period * tasks_[i].period;
+            advance(state, cuts[k + 1], segmentSinks[k]);
+            if (state.run.length > 0)
+                intervals[k].push_back(state.run);
+            misses[k] = move(state.misses);
+            jobs[k] = move(state.jobs);
+            preemptions[k] = state.preemptions;
+            responses[k] = move(state.responses);
+        }
+    };
+    vector<thread> workers;
+    for (int w = 1; w < threads_ && w < static_cast<int>(segments); ++w)
+        workers.emplace_back(simulateSegments);
+    simulateSegments();
+    for (auto &worker : workers)
+        worker.join();
+
+    // stitch, joining a run that carries on across a cut
+    misses_.clear();
+    jobs_.clear();
+    preemptions_ = accumulate(preemptions.begin(), preemptions.end(), 0LL);
+    responses_ = responses[0];
+    for (size_t k = 1; k < segments; ++k)
         for (size_t i = 0; i < tasks_.size(); ++i)
+            responses_[i].merge(responses[k][i]);
+    TimelineInterval run = {IDLE_TASK, 0, 0};
+    for (size_t k = 0; k < segments; ++k)
+    {
+        // a segment's events all come ahead of its runs, which sinks that order them by time take
+        // the same as the interleaving of one simulation
+        segmentSinks[k].replay(sink);
+        for (const auto &interval : intervals[k])
         {
-            if (choice_ == CHOICE_RM || choice_ == CHOICE_DM || choice_ == CHOICE_ARB_DEADLINE)
+            if (interval.taskId == run.taskId && run.length > 0)
             {
-                if (remaining[i] > 0 && tasks_[i].priority > priority)
-                {
-                    priority = tasks_[i].priority;
-
-                    runningTask = i;
-                }
+                run.length += interval.length;
+                continue;
             }
-            else if (choice_ == CHOICE_EDF)
+            if (run.length > 0)
+                sink.push(run);
+            run = interval;
+        }
+        misses_.insert(misses_.end(), misses[k].begin(), misses[k].end());
+        jobs_.insert(jobs_.end(), jobs[k].begin(), jobs[k].end());
+    }
+    if (run.length > 0)
+        sink.push(run);
+    sink.finish();
+}
+
+SimulationState Scheduler::startSimulation(bool recordsJobs) const
+{
+    SimulationState state;
+    state.recordsJobs = recordsJobs;
+    state.pending.resize(tasks_.size());
+    state.nextRelease.assign(tasks_.size(), 0);
+    state.skippedReleases.assign(tasks_.size(), 0);
+    for (const auto &task : tasks_)
+        state.responses.emplace_back((2LL * task.deadline + RESPONSE_BUCKETS - 1) / RESPONSE_BUCKETS);
+    return state;
+}
+
+// The processor has just run out of work: nothing is left for the last task to continue, so
+// the schedule from here does not depend on what ran before
+static void forgetPreviousIfIdle(SimulationState &state)
+{
+    for (const auto &jobs : state.pending)
+        if (!jobs.empty())
+            return;
+    state.previousTask = -1;
+}
+
+void Scheduler::checkDeadlines(SimulationState &state, TimelineSink &sink) const
+{
+    for (size_t i = 0; i < tasks_.size(); ++i)
+    {
+        deque<PendingJob> &jobs = state.pending[i];
+        // jobs of a task share the relative deadline, so the late ones are at the front
+        for (size_t j = 0; j < jobs.size() && jobs[j].deadline <= state.time;)
+        {
+            PendingJob &job = jobs[j];
+            if (job.miss >= 0)
             {
-                if (remaining[i] > 0)
-                {
-                    if (nextDeadline[i] < minDeadline)
-                    {
-                        minDeadline = nextDeadline[i];
-                        runningTask = i;
-                    }
-                    else if (nextDeadline[i] == minDeadline &&remaining[previousTask]>0)
-                    {
-                        runningTask = previousTask;
-                    }
-                }
+                ++j;
+                continue;
             }
-            else if (choice_ == CHOICE_LST)
+            job.miss = static_cast<int>(state.misses.size());
+            state.misses.push_back({tasks_[i].id, job.release, job.deadline, -1});
+            sink.deadline(tasks_[i].id, job.deadline, false);
+            if (stopAtFirstMiss_)
+                state.stopped = true;
+            if (missPolicy_ == MISS_ABORT)
             {
-                int slack = (nextDeadline[i] - t) - remaining[i];
-                if (remaining[i] > 0)
-                {
-                    if (slack < minSlack)
-                    {
-                        minSlack = slack;
-                        runningTask = i;
-                    }
-                    else if (slack == minSlack && remaining[previousTask] > 0)
-                    {
-                        runningTask = previousTask;
-                    }
-                }
+                if (job.record >= 0)
+                    state.jobs[job.record].aborted = true;
+                jobs.erase(jobs.begin() + j);
+                INSTRUMENT_COUNT(COUNTER_READY_QUEUE_OPS, 1);
+                forgetPreviousIfIdle(state);
+                continue;
             }
+            if (missPolicy_ == MISS_SKIP_NEXT)
+                state.skippedReleases[i]++;
+            ++j;
         }
+    }
+}
+
+// Laxity changes linearly: the running job's stays put and every waiting job's drops by one per
+// tick. So the LST schedule can only change at a release, a deadline, a completion, the end of a
+// quantum, or when a waiting job's laxity drops below the running one's, all of which are known in
+// advance. Events are (time, epoch) in a min-heap; completion, quantum and crossing events belong
+// to one dispatch decision and go stale with the next one, releases and deadlines never do.
+void Scheduler::advanceLaxityEvents(SimulationState &state, long long until, TimelineSink &sink) const
+{
+    typedef pair<long long, long long> Event;
+    const long long always = -1;
+    priority_queue<Event, vector<Event>, greater<Event>> events;
+    long long epoch = 0;
+    auto schedule = [&](long long time, long long stamp) {
+        if (time > state.time && time < until)
+            events.push({time, stamp});
+    };
+    for (size_t i = 0; i < tasks_.size(); ++i)
+    {
+        schedule(state.nextRelease[i], always);
+        for (const auto &job : state.pending[i])
+            schedule(job.deadline, always);
+    }
 
-        // Print which task runs
-        if (runningTask != -1)
+    while (state.time < until)
+    {
+        const long long t = state.time;
+        checkDeadlines(state, sink);
+        if (state.stopped)
+            return;
+        releaseJobs(state, sink);
+        for (size_t i = 0; i < tasks_.size(); ++i)
         {
-			timeline.push_back("|T" + std::to_string(tasks_[runningTask].id));
-            std::cout << "|T" << tasks_[runningTask].id;
-            remaining[runningTask]--;
-            previousTask = runningTask;
+            if (state.nextRelease[i] - tasks_[i].period != t)
+                continue;
+            schedule(state.nextRelease[i], always);
+            if (!state.pending[i].empty() && state.pending[i].back().release == t)
+                schedule(state.pending[i].back().deadline, always);
         }
-        else
+
+        // within its quantum the job that ran last keeps the processor
+        const int previous = state.previousTask;
+        bool holding = quantum_ > 1 && previous >= 0 && !state.pending[previous].empty() &&
+                       state.pending[previous].front().release == state.previousRelease && t - state.dispatched < quantum_;
+        int task = holding ? previous : selectTask(state);
+        ++epoch;
+        INSTRUMENT_COUNT(COUNTER_SIMULATION_EVENTS, 1);
+        if (task != -1)
         {
-			timeline.push_back("|ID");
-            std::cout << "|ID";
+            const PendingJob &job = state.pending[task].front();
+            schedule(t + job.remaining, epoch);
+            // no job of lower laxity takes over before the quantum is up
+            long long dispatched = task == previous && job.release == state.previousRelease ? state.dispatched : t;
+            const long long holdUntil = dispatched + quantum_;
+            const long long laxity = (job.deadline - t) - job.remaining;
+            for (size_t i = 0; i < tasks_.size(); ++i)
+            {
+                if (static_cast<int>(i) == task || state.pending[i].empty())
+                    continue;
+                const PendingJob &waiting = state.pending[i].front();
+                // a tie keeps the running job, one tick later the waiting job is strictly lower
+                long long crossing = t + (waiting.deadline - t) - waiting.remaining - laxity + 1;
+                schedule(max(crossing, holdUntil), epoch);
+            }
         }
+
+        while (!events.empty() && (events.top().first <= t || (events.top().second != always && events.top().second != epoch)))
+            events.pop();
+        long long next = events.empty() ? until : events.top().first;
+        INSTRUMENT_COUNT(COUNTER_SIMULATION_TICKS, next - t);
+        runFor(state, task, next - t, sink);
     }
-    std::cout << "|\n";
+    // a job due exactly at until has had all the time it gets
+    checkDeadlines(state, sink);
 }
 
-void Scheduler::displayTimeline() {
-    std::string fontPath = "C:\\Fonts\\arial.ttf";
-    if (!std::filesystem::exists(fontPath)) {
-        std::cerr << "Font file does not exist at: " << fontPath << std::endl;
-        return;
+void Scheduler::setMinimumQuantum(long long ticks)
+{
+    if (ticks < 1)
+        throw runtime_error("Invalid minimum quantum " + to_string(ticks));
+    quantum_ = ticks;
+}
+
+static void releaseJob(const Task &task, SimulationState &state, size_t i, TimelineSink &sink)
+{
+    if (state.skippedReleases[i] > 0)
+        state.skippedReleases[i]--;
+    else
+    {
+        state.pending[i].push_back({state.time, state.time + task.deadline, task.WCET});
+        INSTRUMENT_COUNT(COUNTER_READY_QUEUE_OPS, 1);
+        sink.release(task.id, state.time);
+        if (state.recordsJobs)
+        {
+            state.pending[i].back().record = static_cast<int>(state.jobs.size());
+            state.jobs.push_back({task.id, state.time, state.time + task.deadline});
+        }
     }
+    state.nextRelease[i] += task.period;
+}
 
-    sf::Font font;
-    if (!font.loadFromFile(fontPath)) {
-        std::cerr << "Failed to load font from: " << fontPath << std::endl;
+void Scheduler::releaseJobs(SimulationState &state, TimelineSink &sink) const
+{
+    if (state.releases)
+    {
+        const vector<ReleaseEvent> &releases = *state.releases;
+        size_t &k = state.releaseCursor;
+        for (; k < releases.size() && releases[k].time <= state.time; ++k)
+            releaseJob(tasks_[releases[k].task], state, releases[k].task, sink);
         return;
     }
+    for (size_t i = 0; i < tasks_.size(); ++i)
+    {
+        if (state.time == state.nextRelease[i])
+            releaseJob(tasks_[i], state, i, sink);
+    }
+}
 
-    const int blockWidth = 20;
-    const int blockHeight = 50;
-    const int spacing = 0;
-    const int maxTimelineSteps = std::min<size_t>(1000, timeline.size());
-    const int stepsPerLine = 50;
-    const int marginLeft = 50;
-    const int marginTop = 80;
-
-    const int blocksPerLine = std::min(stepsPerLine, static_cast<int>(maxTimelineSteps));
-    const int lines = (maxTimelineSteps + stepsPerLine - 1) / stepsPerLine;
-
-    const int windowWidth = blocksPerLine * (blockWidth + spacing) + marginLeft * 2;
-    const int windowHeight = lines * (blockHeight + 60) + marginTop * 2;
-
-    sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Scheduler Timeline");
-
-    std::map<std::string, sf::Color> taskColors;
-    std::vector<sf::Color> colors = {
-        sf::Color::Red, sf::Color::Green, sf::Color::Blue,
-        sf::Color::Yellow, sf::Color::Magenta, sf::Color::Cyan,
-        sf::Color(255, 165, 0),   // Orange
-        sf::Color(128, 0, 128),   // Purple
-        sf::Color(0, 128, 128),   // Teal
-        sf::Color(210, 105, 30),  // DBrown
-        sf::Color(75, 0, 130),    // Indigo
-        sf::Color(60, 179, 113),  // LGreen
-        sf::Color(255, 105, 180), // HotPink
-        sf::Color(47, 79, 79),    // DGray
-        sf::Color(255, 215, 0)    // Gold
+int Scheduler::selectTask(const SimulationState &state) const
+{
+    // with D > T a task can have several jobs pending; only the oldest one may run
+    auto key = [&](size_t i) -> long long {
+        const PendingJob &job = state.pending[i].front();
+        if (choice_ == CHOICE_EDF)
+            return job.deadline;
+        if (choice_ == CHOICE_LST)
+            return (job.deadline - state.time) - job.remaining;
+        return -tasks_[i].priority;
     };
-    int colorIndex = 0;
-
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
+    int selected = -1;
+    long long best = LLONG_MAX;
+    for (size_t i = 0; i < tasks_.size(); ++i)
+    {
+        if (!state.pending[i].empty() && key(i) < best)
+        {
+            best = key(i);
+            selected = i;
         }
+    }
+    // EDF and LST keep the task that ran last on a tie instead of switching
+    const int previous = state.previousTask;
+    if ((choice_ == CHOICE_EDF || choice_ == CHOICE_LST) && previous >= 0 && !state.pending[previous].empty() &&
+        key(previous) == best)
+        selected = previous;
+    return selected;
+}
 
-        window.clear(sf::Color::White);
-
-        for (int i = 0; i < maxTimelineSteps; ++i) {
-            int row = i / stepsPerLine;
-            int col = i % stepsPerLine;
-
-            std::string entry = timeline[i].substr(1); // remove '|'
+void Scheduler::runFor(SimulationState &state, int task, long long ticks, TimelineSink &sink) const
+{
+    const long long t = state.time;
+    int taskId = IDLE_TASK;
+    if (task != -1)
+    {
+        taskId = tasks_[task].id;
+        PendingJob &job = state.pending[task].front();
+        if (job.start < 0)
+            job.start = t;
+        const int previous = state.previousTask;
+        // the job that ran last is cut short if it is still pending and another one takes over
+        if (previous >= 0 && previous != task && !state.pending[previous].empty() &&
+            state.pending[previous].front().release == state.previousRelease)
+            state.preemptions++;
+        if (previous != task || job.release != state.previousRelease)
+            state.dispatched = t;
+        state.previousTask = task;
+        state.previousRelease = job.release;
+        job.remaining -= ticks;
+        if (job.remaining == 0)
+        {
+            if (job.miss >= 0)
+                state.misses[job.miss].completion = t + ticks;
+            else
+                sink.deadline(taskId, job.deadline, true);
+            if (job.record >= 0)
+                state.jobs[job.record].completion = t + ticks;
+            state.responses[task].add(t + ticks - job.release, job.start - job.release);
+            state.pending[task].pop_front();
+            INSTRUMENT_COUNT(COUNTER_READY_QUEUE_OPS, 1);
+            if (state.pending[task].empty())
+                forgetPreviousIfIdle(state);
+        }
+    }
 
-            float x = marginLeft + col * (blockWidth + spacing);
-            float y = marginTop + row * (blockHeight + 60);
+    // a change of task closes the current run
+    TimelineInterval &run = state.run;
+    if (taskId != run.taskId && run.length > 0)
+    {
+        sink.push(run);
+        run = {taskId, t, 0};
+    }
+    run.taskId = taskId;
+    run.length += ticks;
+    state.time += ticks;
+}
 
-            sf::RectangleShape block(sf::Vector2f(blockWidth, blockHeight));
-            block.setPosition(x, y);
+void Scheduler::advance(SimulationState &state, long long until, TimelineSink &sink) const
+{
+    if (choice_ == CHOICE_LST)
+    {
+        advanceLaxityEvents(state, until, sink);
+        return;
+    }
+    while (state.time < until)
+    {
+        checkDeadlines(state, sink);
+        if (state.stopped)
+            return;
+        releaseJobs(state, sink);
+        INSTRUMENT_COUNT(COUNTER_SIMULATION_TICKS, 1);
+        runFor(state, selectTask(state), 1, sink);
+    }
+    // a job due exactly at until has had all the time it gets
+    checkDeadlines(state, sink);
+}
 
-            if (entry == "ID") {
-                block.setFillColor(sf::Color::Black);
-            }
-            else {
-                if (taskColors.find(entry) == taskColors.end()) {
-                    taskColors[entry] = colors[colorIndex++ % colors.size()];
-                }
-                block.setFillColor(taskColors[entry]);
-            }
+void Scheduler::finishSimulation(SimulationState &state, TimelineSink &sink)
+{
+    if (state.run.length > 0)
+        sink.push(state.run);
+    state.run = {IDLE_TASK, state.time, 0};
+    misses_ = state.misses;
+    jobs_ = move(state.jobs);
+    preemptions_ = state.preemptions;
+    responses_ = state.responses;
+    sink.finish();
+}
 
-            window.draw(block);
-
-            sf::Text text(entry, font, 12);
-            text.setFillColor(sf::Color::Black);
-            text.setPosition(x, y + blockHeight + 2);
-            window.draw(text);
-        }
-
-        for (int row = 0; row < lines; ++row) {
-            float y = marginTop + row * (blockHeight + 60) + blockHeight + 25;
-            float startX = marginLeft - 10;
-            float endX = marginLeft + blocksPerLine * (blockWidth + spacing);
-
-            // Draw horizontal timeline line
-            sf::Vertex line[] = {
-                sf::Vertex(sf::Vector2f(startX, y), sf::Color::Black),
-                sf::Vertex(sf::Vector2f(endX, y), sf::Color::Black)
-            };
-            window.draw(line, 2, sf::Lines);
-
-            //Only draw left arrow for first row
-            if (row == 0) {
-                sf::CircleShape leftArrow(5, 3);
-                leftArrow.setRotation(270);
-                leftArrow.setPosition(startX, y +5);
-                leftArrow.setFillColor(sf::Color::Black);
-                window.draw(leftArrow);
-            }
+// The backlog at a hyperperiod boundary, relative to the boundary: for every task its next
+// release and the deadline and remaining work of each pending job
+static vector<long long> backlogAt(const SimulationState &state, bool breaksTies)
+{
+    vector<long long> backlog;
+    for (size_t i = 0; i < state.pending.size(); ++i)
+    {
+        backlog.push_back(state.nextRelease[i] - state.time);
+        backlog.push_back(state.skippedReleases[i]);
+        backlog.push_back(static_cast<long long>(state.pending[i].size()));
+        for (const auto &job : state.pending[i])
+        {
+            backlog.push_back(job.deadline - state.time);
+            backlog.push_back(job.remaining);
+        }
+    }
+    // the task that ran last breaks EDF and LST ties, but only while it has work left
+    int previous = state.previousTask;
+    backlog.push_back(breaksTies && previous >= 0 && !state.pending[previous].empty() ? previous : -1);
+    return backlog;
+}
 
-            //Only draw right arrow for the last row
-            if (row == lines - 1) {
-                sf::CircleShape rightArrow(5, 3);
-                rightArrow.setRotation(90);
-                rightArrow.setPosition(endX + 8, y - 5);
-                rightArrow.setFillColor(sf::Color::Black);
-                window.draw(rightArrow);
-            }
+static uint64_t hashBacklog(const vector<long long> &backlog)
+{
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for (long long value : backlog)
+    {
+        for (int byte = 0; byte < 8; ++byte)
+        {
+            hash ^= (static_cast<uint64_t>(value) >> (8 * byte)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
 
-            for (int step = 0; step <= stepsPerLine && (row * stepsPerLine + step) <= maxTimelineSteps; ++step) {
-                float tickX = marginLeft + step * (blockWidth + spacing);
-                sf::Vertex tick[] = {
-                    sf::Vertex(sf::Vector2f(tickX, y - 5), sf::Color::Black),
-                    sf::Vertex(sf::Vector2f(tickX, y + 5), sf::Color::Black)
-                };
-                window.draw(tick, 2, sf::Lines);
-
-                if ((step + row * stepsPerLine) % 5 == 0) {
-                    sf::Text label(std::to_string(step + row * stepsPerLine), font, 12);
-                    label.setFillColor(sf::Color::Black);
-                    label.setPosition(tickX - 5, y + 10);
-                    window.draw(label);
-                }
+FeasibilityResult Scheduler::simulateFeasibilityInterval(TimelineSink &sink, int maxHyperperiods)
+{
+    INSTRUMENT_PHASE(PHASE_SIMULATE);
+    FeasibilityResult result;
+    const long long hyperperiod = computeHyperperiod();
+    UtilizationSum utilization;
+    for (const auto &task : tasks_)
+        utilization.add(task.WCET, task.period);
+    const bool breaksTies = choice_ == CHOICE_EDF || choice_ == CHOICE_LST;
+    SimulationState state = startSimulation();
+    // boundaries seen so far, by backlog hash; the backlog is kept to rule out collisions
+    unordered_multimap<uint64_t, pair<long long, vector<long long>>> seen;
+    vector<long long> backlog = backlogAt(state, breaksTies);
+    seen.insert({hashBacklog(backlog), {0, backlog}});
+
+    for (int k = 1; k <= maxHyperperiods; ++k)
+    {
+        advance(state, k * hyperperiod, sink);
+        if (state.stopped)
+            break;
+        backlog = backlogAt(state, breaksTies);
+        uint64_t hash = hashBacklog(backlog);
+        auto range = seen.equal_range(hash);
+        for (auto it = range.first; it != range.second && !result.steady; ++it)
+        {
+            if (it->second.second == backlog)
+            {
+                result.steady = true;
+                result.cycleStart = it->second.first;
+                result.cycleLength = state.time - it->second.first;
             }
         }
+        if (result.steady)
+            break;
+        seen.insert({hash, {state.time, backlog}});
+        // an overloaded set only ever accumulates backlog, unless late jobs are dropped
+        if (utilization.exceedsOne() && missPolicy_ == MISS_CONTINUE)
+            break;
+    }
+    finishSimulation(state, sink);
+    result.simulated = state.time;
+    result.misses = state.misses;
 
-        //-----------------------------------------
-        // Draw color key at bottom
-        float legendStartY = marginTop + lines * (blockHeight + 60) + 30;
-        float legendX = marginLeft;
-        float legendBlockSize = 15;
-        float legendSpacing = 10;
-        float textOffsetX = legendBlockSize + 5;
-
-        int count = 0;
-        for (const auto& [taskName, color] : taskColors) {
-            float x = legendX + (count % 5) * 150; // max 5 entries per row
-            float y = legendStartY + (count / 5) * 25;
-
-            sf::RectangleShape colorBox(sf::Vector2f(legendBlockSize, legendBlockSize));
-            colorBox.setPosition(x, y);
-            colorBox.setFillColor(color);
-            window.draw(colorBox);
+    cout << "Simulated " << result.simulated << " ticks: ";
+    if (result.steady)
+        cout << "schedule repeats every " << result.cycleLength << " ticks from " << result.cycleStart;
+    else
+        cout << "no steady state found";
+    cout << ", " << result.misses.size() << " deadline misses\n";
+    return result;
+}
 
-            sf::Text label(taskName, font, 14);
-            label.setFillColor(sf::Color::Black);
-            label.setPosition(x + textOffsetX, y - 2);
-            window.draw(label);
+void Scheduler::displayTimeline() {
+    INSTRUMENT_PHASE(PHASE_RENDER);
+    TimelineRenderer renderer;
+    renderer.display(*this);
+}
 
-            count++;
-        }
-        //--------------------------------------------
+int Scheduler::renderTimeline(const std::string &prefix, int stepsPerImage) {
+    INSTRUMENT_PHASE(PHASE_RENDER);
+    TimelineRenderer renderer;
+    return renderer.renderToPNG(*this, prefix, stepsPerImage);
+}
 
-        window.display();
-    }
+bool Scheduler::exportTrace(const std::string &path, long long horizon) {
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    ::exportTrace(*this, file, horizon);
+    return static_cast<bool>(file);
 }
 
 
 
+// Audsley's algorithm: fill priority levels from the lowest up, each time with any unassigned
+// task that meets its deadline while every other unassigned task has higher priority.
+// Priorities end up as 1 (lowest) to n, matching setPriority.
 bool Scheduler::runOPA()
 {
-    bool unassigned = false;
-    std::vector<Task> unassignedTasks(tasks_);
-    std::vector<Task> tasks;
-
+    INSTRUMENT_PHASE(PHASE_ANALYZE);
     cout << "\nAssigning priorities and checking schedulability...\n";
-    for (int j = tasks_.size(); j > 0; j--)
+    vector<size_t> unassigned(tasks_.size());
+    iota(unassigned.begin(), unassigned.end(), 0);
+    vector<Task> higher;
+    higher.reserve(tasks_.size());
+
+    for (int level = 1; !unassigned.empty(); ++level)
     {
-        unassigned = true;
-        for (int k = 0; k < unassignedTasks.size(); k++)
+        bool assigned = false;
+        for (size_t k = 0; k < unassigned.size() && !assigned; ++k)
         {
-            tasks.clear();
-
-            for (const Task &t : tasks_)
+            const Task &candidate = tasks_[unassigned[k]];
+            INSTRUMENT_COUNT(COUNTER_OPA_CANDIDATES, 1);
+            higher.clear();
+            for (size_t i : unassigned)
             {
-                if (t.priority != 0)
-                { // Assume 0 means no priority has been assigned
-                    tasks.push_back(t);
-                }
+                if (i != unassigned[k])
+                    higher.push_back(tasks_[i]);
             }
-
-            Task newTask = unassignedTasks[k];
-            newTask.priority = j;
-            tasks.push_back(newTask);
-
-            if (runRMDMTest(tasks))
+            long long responseTime = computeResponseTime(candidate, higher, candidate.deadline);
+            if (responseTime <= candidate.deadline)
             {
-                unassignedTasks[k].priority = j; // tasks_.size() - newTask.priority + 1;
-
-                for (int i = 0; i < tasks_.size(); i++)
-                {
-                    if (tasks_[i].id == unassignedTasks[k].id)
-                    {
-                        tasks_[i] = unassignedTasks[k];
-                        break;
-                    }
-                }
-
-                unassignedTasks.erase(unassignedTasks.begin() + k);
-                unassigned = false;
+                tasks_[unassigned[k]].priority = level;
+                cout << candidate.id << " priority: " << level << " (response time " << responseTime << ")\n";
+                unassigned.erase(unassigned.begin() + k);
+                assigned = true;
             }
         }
-        if (unassigned)
+        if (!assigned)
         {
+            cout << "No task can take priority level " << level << "\n";
             return false;
         }
     }
-
-    for (int i = 0; i < tasks.size(); i++)
-    {
-        tasks[i].priority = tasks.size() - tasks[i].priority + 1;
-        cout << tasks[i].id << " priority: " << tasks[i].priority << '\n';
-    }
-    tasks_ = tasks;
-
     return true;
 }
 
 
-Inheritance::Inheritance(vector<Job>& taskList, int numOfResource, int choice) : jobs(taskList), numOfResource(numOfResource), choice_(choice) {
+Inheritance::Inheritance(vector<Job>& taskList, int numOfResource, int choice, int horizon) : templates(taskList), jobs(taskList), numOfResource(numOfResource), choice_(choice), horizon_(horizon) {
     for (int i = 1; i <= numOfResource; ++i) {
         Resource res;
         res.id = i;
         resources.push_back(res);
     }
-    for (auto& task : jobs) {
-        task.RWCET = task.WCET;
-        task.currentPriority = task.basePriority;
-        for (auto& resource : task.resourceSequence)
+    openHold.assign(numOfResource, -1);
+    assignPreemptionLevels(templates);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        templates[i].sections = flattenCriticalSections(templates[i]);
+        Job& task = jobs[i];
+        task.sections = templates[i].sections;
+        task.preemptionLevel = templates[i].preemptionLevel;
+        jobIndex[task.id] = i;
+        releaseJob(task, templates[i], 0);
+        // under SRP the ceiling is expressed in preemption levels instead of priorities
+        int level = (choice_ == CHOICE_SRP) ? task.preemptionLevel : task.basePriority;
+        for (auto& section : task.sections)
         {
-            Resource& res = getResourceById(resource.id);
-            if (res.ceilingPriority < task.basePriority)
-                res.ceilingPriority = task.basePriority;
+            Resource& res = getResourceById(section.resourceId);
+            if (res.ceilingPriority < level)
+                res.ceilingPriority = level;
         }
     }
+    if (horizon_ > 0)
+        timeline.reserve(horizon_);
+    // every instance released before the horizon locks each of its sections once
+    size_t spans = 0;
+    for (const auto& jobTemplate : templates) {
+        long long instances = 1;
+        if (horizon_ > 0)
+            instances = jobTemplate.releaseTime < horizon_ ? (horizon_ - 1 - jobTemplate.releaseTime) / max(jobTemplate.period, 1) + 1 : 0;
+        spans += jobTemplate.sections.size() * instances;
+    }
+    holds.reserve(spans);
+}
+
+const vector<Job>& Inheritance::getJobTemplates() const
+{
+    return templates;
+}
+
+const vector<Resource>& Inheritance::getResources() const
+{
+    return resources;
+}
+
+int Inheritance::getChoice() const
+{
+    return choice_;
+}
+
+int Inheritance::getHorizon() const
+{
+    return horizon_;
+}
+
+int Inheritance::computeHyperperiod() const
+{
+    int h = 1;
+    for (const auto &job : templates)
+    {
+        h = lcm(h, job.period);
+    }
+    return h;
+}
+
+// Reuses the job's record for its next instance. The lock stacks keep their capacity,
+// so resetting them never allocates.
+void Inheritance::releaseJob(Job& job, const Job& jobTemplate, int instance)
+{
+    job.instance = instance;
+    job.releaseTime = jobTemplate.releaseTime + instance * jobTemplate.period;
+    job.deadline = jobTemplate.deadline + instance * jobTemplate.period;
+    job.RWCET = jobTemplate.WCET;
+    job.currentPriority = jobTemplate.basePriority;
+    job.isBlocked = false;
+    job.isFinished = false;
+    job.nextSection = 0;
+    job.lockStack.clear();
+    job.savedPriority.clear();
+}
+
+static void flattenSections(const vector<ResourceRequest>& requests, int start, int end, vector<CriticalSection>& sections)
+{
+    for (const auto& request : requests) {
+        if (request.duration <= 0 || start + request.duration > end)
+            throw runtime_error("Invalid critical section nesting");
+        sections.push_back({ request.id, start, start + request.duration });
+        flattenSections(request.nested, start + 1, start + request.duration, sections);
+        start += request.duration;
+    }
+}
+
+vector<CriticalSection> flattenCriticalSections(const Job& job)
+{
+    vector<CriticalSection> sections;
+    flattenSections(job.resourceSequence, 0, job.WCET, sections);
+    return sections;
+}
+
+int relativeDeadline(const Job& job)
+{
+    return job.deadline - job.releaseTime;
+}
+
+void assignPreemptionLevels(vector<Job>& jobs)
+{
+    vector<int> deadlines;
+    for (const auto& job : jobs)
+        deadlines.push_back(relativeDeadline(job));
+    sort(deadlines.begin(), deadlines.end(), greater<int>());
+    deadlines.erase(unique(deadlines.begin(), deadlines.end()), deadlines.end());
+    for (auto& job : jobs)
+        job.preemptionLevel = static_cast<int>(find(deadlines.begin(), deadlines.end(), relativeDeadline(job)) - deadlines.begin()) + 1;
 }
 
 void Inheritance::simulateResource()
 {
+    INSTRUMENT_PHASE(PHASE_SIMULATE);
     cout << "Starting Simulation\n";
     Job* prevTask = nullptr;
 
-    while (!allTasksFinished())
+    while (horizon_ > 0 ? time < horizon_ : !allTasksFinished())
     {
+        for (auto& job : jobs) {
+            // releaseJob keeps releaseTime and deadline at those of the current instance
+            if (!job.isFinished && (job.deadline < time || job.releaseTime + job.period < time)) {
+                cout << " T" << job.id << " exceeds its period or missed its deadline at time:  " << time << "\n";
+                return;
+            }
+        }
+        cout << "Time: " << time << "\n";
+        if (prevTask)
+            updateResourceUsage(*prevTask);
 
-
-        while (!allTasksFinished()) {
-            for (auto& job : jobs) {
-                if (job.deadline < time || job.period < time) {
-                    cout << " T" << job.id << " exceeds its period or missed its deadline at time:  " << time << "\n";
+        // periodic releases recycle the finished record of the previous instance
+        if (horizon_ > 0) {
+            for (size_t i = 0; i < jobs.size(); ++i) {
+                const Job& jobTemplate = templates[i];
+                if (time != jobTemplate.releaseTime + (jobs[i].instance + 1) * jobTemplate.period)
+                    continue;
+                if (!jobs[i].isFinished) {
+                    cout << " T" << jobs[i].id << " exceeds its period or missed its deadline at time:  " << time << "\n";
                     return;
                 }
+                releaseJob(jobs[i], jobTemplate, jobs[i].instance + 1);
+                cout << "  T" << jobs[i].id << " released\n";
             }
-            cout << "Time: " << time << "\n";
-            updateResourceUsage(*prevTask);
-            Job* nextTask = getNextRunnableTask();
+        }
 
-            if (nextTask)
-            {
-                runTask(*nextTask);
-                prevTask = nextTask;
-            }
-            else
-            {
-                cout << "  CPU Idle\n";
-                prevTask = nullptr;
-            }
-            time++;
+        INSTRUMENT_COUNT(COUNTER_SIMULATION_TICKS, 1);
+        Job* nextTask = getNextRunnableTask();
+
+        if (nextTask)
+        {
+            runTask(*nextTask);
+            prevTask = nextTask;
+        }
+        else
+        {
+            cout << "  CPU Idle\n";
+            prevTask = nullptr;
         }
-        cout << "Simulation complete.\n";
+        time++;
     }
+    // account for a job that completed in the last simulated tick
+    if (horizon_ > 0 && prevTask)
+        updateResourceUsage(*prevTask);
+    cout << "Simulation complete.\n";
 }
 
 void Inheritance::updateResourceUsage(Job &job)
 {
-    if (&job == nullptr)
-        return;
     if (job.RWCET == 0)
     {
         job.isFinished = true;
         cout << "  " << job.id << " finished execution\n";
+        if (choice_ == CHOICE_SRP)
+        {
+            // SRP never lets a job block once started, so the finishing job is always on top
+            if (executionStack.empty() || executionStack.back() != job.id)
+                throw logic_error("T" + to_string(job.id) + " is not on top of the shared stack");
+            executionStack.pop_back();
+            stackUsage -= job.stackSize;
+        }
     }
-    for (auto &resourceRequest : job.resourceSequence)
+    // sections are properly nested, so any section ending now is on top of the lock stack
+    int executed = job.WCET - job.RWCET;
+    while (!job.lockStack.empty() && job.sections[job.lockStack.back()].end == executed)
     {
-        Resource &resource = getResourceById(resourceRequest.id);
-        if (resource.heldBy == job.id)
-            resourceRequest.duration--;
-
-        if (resourceRequest.duration == 0 && resource.isHeld && resource.heldBy == job.id) {
-
-            resource.isHeld = false;
-            resource.heldBy = 0;
-            job.currentPriority = job.basePriority;
-
-            cout << " T" << job.id << " released R" << resourceRequest.id << "\n";
-            if (choice_ == CHOICE_ICPP || choice_ == CHOICE_OCPP)
-            {
-                for (auto &res : job.resourceSequence)
-                {
-                    Resource &reso = getResourceById(res.id);
-
-                    if (reso.ceilingPriority > job.currentPriority && reso.heldBy == job.id)
-                        job.currentPriority = reso.ceilingPriority;
-                }
-            }
-            resourceRequest.isFinished = true;
-            for (auto &j : jobs)
+        int resourceId = job.sections[job.lockStack.back()].resourceId;
+        unlockResource(getResourceById(resourceId));
+        job.lockStack.pop_back();
+        job.currentPriority = job.savedPriority.back();
+        job.savedPriority.pop_back();
+        cout << " T" << job.id << " released R" << resourceId << "\n";
+
+        for (auto &j : jobs)
+        {
+            if (j.isBlocked && (choice_ == CHOICE_OCPP || j.waitingFor == resourceId))
+                j.isBlocked = false;
+        }
+        // jobs still waiting on an outer lock keep their priority inherited
+        for (const auto &j : jobs)
+        {
+            if (j.isBlocked && getResourceById(j.waitingFor).heldBy == job.id && j.currentPriority > job.currentPriority)
             {
-                if (choice_ == CHOICE_OCPP)
-                {
-                    if (j.isBlocked)
-                    {
-                        j.isBlocked = false;
-                    }
-                }
-                else
-                {
-                    if (j.isBlocked && j.waitingFor == resourceRequest.id)
-                        j.isBlocked = false;
-                }
+                job.currentPriority = j.currentPriority;
+                INSTRUMENT_COUNT(COUNTER_INHERITANCE_EVENTS, 1);
             }
         }
     }
@@ -626,11 +1304,20 @@ void Inheritance::updateResourceUsage(Job &job)
 
 Job* Inheritance::getNextRunnableTask() {
     Job* selected = nullptr;
+    int systemCeiling = lockedCeilings.empty() ? 0 : lockedCeilings.begin()->first;
 	//find the next task with the highest priority
 	for (auto& t : jobs) {
 		if (t.isFinished || t.releaseTime > time || t.isBlocked)
 			continue;
-		if (!selected || t.currentPriority > selected->currentPriority)
+        if (choice_ == CHOICE_SRP)
+        {
+            // EDF, but a job may only start once its preemption level exceeds the system ceiling
+            if (t.RWCET == t.WCET && t.preemptionLevel <= systemCeiling)
+                continue;
+            if (!selected || t.deadline < selected->deadline)
+                selected = &t;
+        }
+		else if (!selected || t.currentPriority > selected->currentPriority)
 			selected = &t;
 	}
     if (!selected) {
@@ -639,73 +1326,49 @@ Job* Inheritance::getNextRunnableTask() {
 
     }
 
+    // lock the next critical section once the job has executed up to its start
+    int executed = selected->WCET - selected->RWCET;
+    if (selected->nextSection >= static_cast<int>(selected->sections.size()) ||
+        selected->sections[selected->nextSection].start != executed)
+        return selected;
 
-	for (auto& resourceRequest : selected->resourceSequence) {
-		Resource& resource = getResourceById(resourceRequest.id);
-        if (resource.isHeld && resource.heldBy != selected->id) {
-			cout << " T" << selected->id << " is blocked by T" << resource.heldBy << "\n";
-            Job& prev = getTaskById(resource.heldBy);
-
-            prev.currentPriority = selected->basePriority;
-            selected->isBlocked = true;
-            selected->waitingFor = resourceRequest.id;
-            return getNextRunnableTask();
-        }
+    int resourceId = selected->sections[selected->nextSection].resourceId;
+    Resource& resource = getResourceById(resourceId);
+    Job* holder = nullptr;
+    if (resource.isHeld)
+    {
+        holder = &getTaskById(resource.heldBy);
+    }
+    else if (choice_ == CHOICE_OCPP)
+    {
+        // blocked on the system ceiling, so the holder of that ceiling inherits our priority
+        Resource* ceilingResource = getCeilingResource(*selected);
+        if (ceilingResource && selected->currentPriority <= ceilingResource->ceilingPriority)
+            holder = &getTaskById(ceilingResource->heldBy);
+    }
 
-        else if (!resource.isHeld && !resourceRequest.isFinished)
+    if (holder)
+    {
+        cout << " T" << selected->id << " is blocked by T" << holder->id << "\n";
+        INSTRUMENT_COUNT(COUNTER_BLOCKING_EVENTS, 1);
+        if (holder->currentPriority < selected->currentPriority)
         {
-
-            if (choice_ == CHOICE_OCPP)
-            {
-                int lockedCeiling = 0;
-                string resourceID = "";
-                for (int i = 0; i < resources.size(); i++)
-                {
-                    if (resources[i].ceilingPriority > lockedCeiling && resources[i].heldBy != selected->id && resources[i].isHeld)
-                    {
-                        lockedCeiling = resources[i].ceilingPriority;
-                    }
-                }
-                if (selected->currentPriority > lockedCeiling)
-                {
-                    resource.isHeld = true;
-                    resource.heldBy = selected->id;
-                    cout << "  T" << selected->id << " acquired R" << resource.id << "\n";
-                }
-                else
-                {
-
-                    for (int i = 0; i < resources.size(); i++)
-                    {
-                        for (int j = 0; j < jobs.size(); j++)
-                        {
-                            if (resources[i].isHeld && jobs[j].id != selected->id &&
-                                jobs[j].id == resources[i].heldBy && jobs[j].currentPriority < selected->currentPriority)
-                            {
-                                jobs[j].currentPriority = selected->currentPriority;
-                                selected->isBlocked = true;
-                                selected->waitingFor = resourceRequest.id;
-                                return getNextRunnableTask();
-                            }
-                        }
-                    }
-                }
-            }
-            else
-            {
-                resource.isHeld = true;
-                resource.heldBy = selected->id;
-                cout << "  T" << selected->id << " acquired R" << resource.id << "\n";
-                if (choice_ == CHOICE_ICPP)
-                {
-                    if (selected->currentPriority < resource.ceilingPriority)
-                        selected->currentPriority = resource.ceilingPriority;
-                }
-
-            }
-
-            break;
+            holder->currentPriority = selected->currentPriority;
+            INSTRUMENT_COUNT(COUNTER_INHERITANCE_EVENTS, 1);
         }
+        selected->isBlocked = true;
+        selected->waitingFor = resourceId;
+        return getNextRunnableTask();
+    }
+
+    lockResource(resource, *selected);
+    selected->savedPriority.push_back(selected->currentPriority);
+    selected->lockStack.push_back(selected->nextSection++);
+    cout << "  T" << selected->id << " acquired R" << resource.id << "\n";
+    if (choice_ == CHOICE_ICPP && selected->currentPriority < resource.ceilingPriority)
+    {
+        selected->currentPriority = resource.ceilingPriority;
+        INSTRUMENT_COUNT(COUNTER_INHERITANCE_EVENTS, 1);
     }
 
     return selected;
@@ -720,247 +1383,91 @@ bool Inheritance::allTasksFinished()
 
 void Inheritance::runTask(Job& job) {
     cout << "  Running T" << job.id << "\n";
-	vector<Resource> res;
-    for (auto& resource : resources) {
-		if (resource.heldBy == job.id) {
-			res.push_back(resource);
-		}
+    if (choice_ == CHOICE_SRP && job.RWCET == job.WCET)
+    {
+        executionStack.push_back(job.id);
+        stackUsage += job.stackSize;
+        peakStackUsage = max(peakStackUsage, stackUsage);
     }
-	timeline.push_back({ "T" + to_string(job.id),res , time });
+	timeline.push_back({ job.id, time, job.currentPriority });
     job.RWCET--;  
 }
 
 Job& Inheritance::getTaskById(const int& id) {
-    for (auto& job : jobs) {
-        if (job.id == id)
-            return job;
-    }
+    auto it = jobIndex.find(id);
+    if (it != jobIndex.end())
+        return jobs[it->second];
     throw runtime_error("Invalid Task ID");
 }
 
 
 Resource& Inheritance::getResourceById(const int& id) {
-    for (auto& resource : resources) {
-        if (resource.id == id)
-            return resource;
-
-    }
+    // resources are created with ids 1..numOfResource
+    if (id >= 1 && id <= static_cast<int>(resources.size()))
+        return resources[id - 1];
     cout << "Invalid Resource ID: " << id << endl;
     throw runtime_error("Invalid Resource ID");
 }
 
-void Inheritance::displayTimeline() {
-    std::string fontPath = "C:\\Fonts\\arial.ttf";
-    if (!std::filesystem::exists(fontPath)) {
-        std::cerr << "Font file does not exist at: " << fontPath << std::endl;
-        return;
-    }
-
-    sf::Font font;
-    if (!font.loadFromFile(fontPath)) {
-        std::cerr << "Failed to load font from: " << fontPath << std::endl;
-        return;
-    }
-
-    const int blockWidth = 40;
-    const int blockHeight = 60;
-    const int spacing = 2;
-    const int maxTimelineSteps = std::min<size_t>(1000, timeline.size());//max timeline size of 1000
-    const int stepsPerLine = 50;
-    const int marginLeft = 50;
-    const int marginTop = 100;
-
-    const int blocksPerLine = std::min(stepsPerLine, static_cast<int>(maxTimelineSteps));
-    const int lines = (maxTimelineSteps + stepsPerLine - 1) / stepsPerLine;
-
-    const int windowWidth = blocksPerLine * (blockWidth + spacing) + marginLeft * 2;
-    const int windowHeight = lines * (blockHeight + 60) + marginTop * 2;
-
-    sf::RenderWindow window(sf::VideoMode(windowWidth, windowHeight), "Inheritance Simulation Timeline");
-
-    //task tracking
-    std::map<std::string, sf::Color> resourceColors;
-    std::vector<sf::Color> colors = {
-        sf::Color::Red, sf::Color::Green, sf::Color::Blue,
-        sf::Color::Yellow, sf::Color::Magenta, sf::Color::Cyan,
-        sf::Color(255, 165, 0),   // Orange
-        sf::Color(128, 0, 128),   // Purple
-        sf::Color(0, 128, 128),   // Teal
-        sf::Color(210, 105, 30),  // DBrown
-        sf::Color(75, 0, 130),    // Indigo
-        sf::Color(60, 179, 113),  // LGreen
-        sf::Color(255, 105, 180), // HotPink
-        sf::Color(47, 79, 79),    // DGray
-        sf::Color(255, 215, 0)    // Gold
-    };
-    int colorIndex = 0;
-
-    //resource tracking
-    std::map<int, sf::Color> resourceIDColors; // Resource ID to Color
-    std::map<int, std::string> resourceNames;  // Optional: ID to readable name
-
-    // Assign each resource a color
-    for (const auto& entry : timeline) {
-        for (const auto& res : entry.resource) {
-            if (resourceIDColors.find(res.id) == resourceIDColors.end()) {
-                resourceIDColors[res.id] = colors[colorIndex++ % colors.size()];
-                resourceNames[res.id] = "R" + std::to_string(res.id);
-            }
-        }
-    }
-
-
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed)
-                window.close();
-        }
-
-        window.clear(sf::Color::White);
-
-        for (int i = 0; i < maxTimelineSteps; ++i) {
-            int row = i / stepsPerLine;
-            int col = i % stepsPerLine;
-
-            std::string entry = timeline[i].job; // Get job from the timeline entry (adjust as needed)
-
-            float x = marginLeft + col * (blockWidth + spacing);
-            float y = marginTop + row * (blockHeight + 60);
-
-            sf::RectangleShape block(sf::Vector2f(blockWidth, blockHeight));
-            block.setPosition(x, y);
-
-            // Assign a color for each job or resource
-            if (resourceColors.find(entry) == resourceColors.end()) {
-                resourceColors[entry] = colors[colorIndex++ % colors.size()];
-            }
-            block.setFillColor(resourceColors[entry]);
-
-            //draw task block
-            window.draw(block);
-
-            // Draw small dots above the task block for each held resource
-            int dotOffset = 0;
-            for (const auto& res : timeline[i].resource) {
-                int entryTaskID = std::stoi(entry.substr(1));  // Remove 'T' and convert to int
-                if (res.isHeld && res.heldBy == entryTaskID) {
-                    sf::CircleShape dot(4);
-                    dot.setFillColor(resourceIDColors[res.id]);
-                    float dotX = x + dotOffset * 10;
-                    float dotY = y - 10;
-                    dot.setPosition(dotX, dotY);
-                    window.draw(dot);
-
-                    dotOffset++;
-                }
-            }
-
-            sf::Text text(entry, font, 12);
-            text.setFillColor(sf::Color::Black);
-            text.setPosition(x, y + blockHeight + 2);
-            window.draw(text);
-        }
-
-        // Draw horizontal timeline lines and ticks
-        for (int row = 0; row < lines; ++row) {
-            float y = marginTop + row * (blockHeight + 60) + blockHeight + 25;
-            float startX = marginLeft - 10;
-            float endX = marginLeft + blocksPerLine * (blockWidth + spacing);
-
-            // Draw horizontal timeline line
-            sf::Vertex line[] = {
-                sf::Vertex(sf::Vector2f(startX, y), sf::Color::Black),
-                sf::Vertex(sf::Vector2f(endX, y), sf::Color::Black)
-            };
-            window.draw(line, 2, sf::Lines);
-
-            // Draw arrows
-            if (row == 0) {
-                sf::CircleShape leftArrow(5, 3);
-                leftArrow.setRotation(270);
-                leftArrow.setPosition(startX, y + 5);
-                leftArrow.setFillColor(sf::Color::Black);
-                window.draw(leftArrow);
-            }
-
-            if (row == lines - 1) {
-                sf::CircleShape rightArrow(5, 3);
-                rightArrow.setRotation(90);
-                rightArrow.setPosition(endX + 8, y - 5);
-                rightArrow.setFillColor(sf::Color::Black);
-                window.draw(rightArrow);
-            }
-
-            // Draw time unit ticks
-            for (int step = 0; step <= stepsPerLine && (row * stepsPerLine + step) < maxTimelineSteps; ++step) {
-                float tickX = marginLeft + step * (blockWidth + spacing);
-                sf::Vertex tick[] = {
-                    sf::Vertex(sf::Vector2f(tickX, y - 5), sf::Color::Black),
-                    sf::Vertex(sf::Vector2f(tickX, y + 5), sf::Color::Black)
-                };
-                window.draw(tick, 2, sf::Lines);
-
-                if ((step + row * stepsPerLine) % 5 == 0) {
-                    sf::Text label(std::to_string(step + row * stepsPerLine), font, 12);
-                    label.setFillColor(sf::Color::Black);
-                    label.setPosition(tickX - 5, y + 10);
-                    window.draw(label);
-                }
-            }
-        }
-
-        // Combined Legend Block (Tasks + Resources)
-        float legendStartY = marginTop + lines * (blockHeight + 60) + 30;
-        float legendX = marginLeft;
-        float legendBlockSize = 15;
-        float textOffsetX = legendBlockSize + 5;
-        int maxEntriesPerRow = 5;
-        float entrySpacingX = 50;
-        float entrySpacingY = 25;
-
-        int count = 0;
-
-        // Draw Task Legend
-        for (const auto& [taskName, color] : resourceColors) {
-            float x = legendX + (count % maxEntriesPerRow) * entrySpacingX;
-            float y = legendStartY + (count / maxEntriesPerRow) * entrySpacingY;
-
-            sf::RectangleShape colorBox(sf::Vector2f(legendBlockSize, legendBlockSize));
-            colorBox.setPosition(x, y);
-            colorBox.setFillColor(color);
-            window.draw(colorBox);
+const vector<simulate>& Inheritance::getTimeline() const
+{
+    return timeline;
+}
 
-            sf::Text label(taskName, font, 14);
-            label.setFillColor(sf::Color::Black);
-            label.setPosition(x + textOffsetX, y - 2);
-            window.draw(label);
+const vector<ResourceHold>& Inheritance::getResourceHolds() const
+{
+    return holds;
+}
 
-            count++;
-        }
+int Inheritance::getPeakStackUsage() const
+{
+    return peakStackUsage;
+}
 
-        // Compute where to start the resource legend (below the last row of the task legend)
-        int taskLegendRows = (count + maxEntriesPerRow - 1) / maxEntriesPerRow;
-        float resourceLegendStartY = legendStartY + taskLegendRows * entrySpacingY + 10;
+void Inheritance::lockResource(Resource& resource, const Job& job) {
+    resource.isHeld = true;
+    resource.heldBy = job.id;
+    lockedCeilings.insert({ resource.ceilingPriority, resource.id });
+    openHold[resource.id - 1] = static_cast<int>(holds.size());
+    holds.push_back({ resource.id, job.id, time, -1 });
+}
 
-        int rcount = 0;
-        for (const auto& [resID, color] : resourceIDColors) {
-            float x = legendX + (rcount % maxEntriesPerRow) * entrySpacingX;
-            float y = resourceLegendStartY + (rcount / maxEntriesPerRow) * entrySpacingY;
+void Inheritance::unlockResource(Resource& resource) {
+    resource.isHeld = false;
+    resource.heldBy = 0;
+    holds[openHold[resource.id - 1]].end = time;
+    openHold[resource.id - 1] = -1;
+    lockedCeilings.erase(lockedCeilings.find({ resource.ceilingPriority, resource.id }));
+}
 
-            sf::RectangleShape colorBox(sf::Vector2f(legendBlockSize, legendBlockSize));
-            colorBox.setPosition(x, y);
-            colorBox.setFillColor(color);
-            window.draw(colorBox);
+// Highest-ceiling resource locked by a job other than the given one, or nullptr.
+// The scan only steps over the job's own locks at the top of lockedCeilings, so it costs
+// O(1 + locks held by the job) rather than a pass over every resource.
+Resource* Inheritance::getCeilingResource(const Job& job) {
+    for (const auto& [ceiling, id] : lockedCeilings) {
+        Resource& resource = getResourceById(id);
+        if (resource.heldBy != job.id)
+            return &resource;
+    }
+    return nullptr;
+}
 
-            sf::Text label("R" + std::to_string(resID), font, 14);
-            label.setFillColor(sf::Color::Black);
-            label.setPosition(x + textOffsetX, y - 2);
-            window.draw(label);
+void Inheritance::displayTimeline() {
+    INSTRUMENT_PHASE(PHASE_RENDER);
+    TimelineRenderer renderer;
+    renderer.display(*this);
+}
 
-            rcount++;
-        }
-        window.display();
-    }
+int Inheritance::renderTimeline(const std::string& prefix, int stepsPerImage) {
+    INSTRUMENT_PHASE(PHASE_RENDER);
+    TimelineRenderer renderer;
+    return renderer.renderToPNG(*this, prefix, stepsPerImage);
 }
 
+bool Inheritance::exportTrace(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    ::exportTrace(*this, file);
+    return static_cast<bool>(file);
+}
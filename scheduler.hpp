@@ -19,6 +19,9 @@ using namespace std;
 #include <iomanip>
 #include <queue>
 #include <unordered_map>
+#include <climits>
+#include <set>
+#include <deque>
 
 
 
@@ -32,6 +35,32 @@ using namespace std;
 #define CHOICE_OCPP 6
 #define CHOICE_ICPP 7
 #define CHOICE_ARB_DEADLINE 8
+#define CHOICE_SRP 9
+
+// Fixed-priority orderings for Scheduler::setPriority, the first task in the order getting the
+// highest priority
+#define ORDER_RATE_MONOTONIC 0     // shortest period
+#define ORDER_DEADLINE_MONOTONIC 1 // shortest deadline
+#define ORDER_SLACK_MONOTONIC 2    // smallest deadline minus WCET
+#define ORDER_UTILIZATION 3        // largest WCET / period
+#define ORDER_SHORTEST_WCET 4      // smallest WCET
+
+class TimelineSink;
+
+#define IDLE_TASK -1
+
+// What the Scheduler simulation does with a job still running at its deadline
+#define MISS_CONTINUE 0  // the job runs on until it completes
+#define MISS_ABORT 1     // the job is dropped
+#define MISS_SKIP_NEXT 2 // the job runs on and the next release of its task is skipped
+
+// taskId runs from start for length ticks; taskId is IDLE_TASK when the processor is idle
+struct TimelineInterval
+{
+    int taskId;
+    long long start;
+    long long length;
+};
 
 struct Task
 {
@@ -42,28 +71,215 @@ struct Task
     int priority;
 };
 
+// Sum of WCET / period compared with 1 without rounding: the terms are kept as one fraction over
+// the lcm of the periods, and only fall back to long double once that lcm outgrows an int
+class UtilizationSum
+{
+public:
+    void add(long long WCET, long long period);
+    bool exceedsOne() const;
+
+private:
+    long long numerator_ = 0;
+    long long denominator_ = 1;
+    bool exact_ = true;
+    bool exceeded_ = false;
+    long double approximate_ = 0;
+};
+
+// A released job that has not completed yet
+struct PendingJob
+{
+    long long release;
+    long long deadline; // absolute
+    long long remaining;
+    int miss = -1; // index of its DeadlineMiss once the deadline has passed
+    long long start = -1; // first tick it ran
+    int record = -1; // index of its JobRecord when jobs are recorded
+};
+
+#define RESPONSE_BUCKETS 64
+
+// Response times of one task's completed jobs, accumulated as they complete. The histogram has
+// RESPONSE_BUCKETS buckets of bucketWidth ticks, the last one also counting everything beyond.
+// The simulator sizes the buckets to cover twice the deadline, so percentiles are exact for
+// deadlines up to RESPONSE_BUCKETS / 2 ticks.
+struct ResponseStatistics
+{
+    long long jobs = 0;
+    long long minimum = 0;
+    long long maximum = 0;
+    long long total = 0;
+    long long minStartDelay = 0; // release to first run
+    long long maxStartDelay = 0;
+    long long bucketWidth = 1;
+    vector<long long> histogram;
+
+    ResponseStatistics(long long bucketWidth = 1);
+    void add(long long response, long long startDelay);
+    void merge(const ResponseStatistics &other);
+    double mean() const;
+    // Smallest response at least fraction of the jobs stay within, to the bucket's resolution;
+    // the largest response seen when that rank falls in the last, open-ended bucket
+    long long percentile(double fraction) const;
+    long long startJitter() const;
+};
+
+struct DeadlineMiss
+{
+    int taskId;
+    long long release;
+    long long deadline;
+    long long completion; // -1 if the job was aborted or had not completed when the simulation ended
+};
+
+// A job the simulation released; releases dropped by MISS_SKIP_NEXT have none
+struct JobRecord
+{
+    int taskId;
+    long long release;
+    long long deadline;
+    long long completion = -1; // -1 if it never completed
+    bool aborted = false;      // dropped at its deadline under MISS_ABORT
+};
+
+// Release of the next job of the task at the given index
+struct ReleaseEvent
+{
+    long long time;
+    int task;
+};
+
+// Everything the Scheduler simulation carries from one tick to the next
+struct SimulationState
+{
+    long long time = 0;
+    vector<deque<PendingJob>> pending; // per task, oldest job first
+    vector<long long> nextRelease;
+    vector<int> skippedReleases; // releases MISS_SKIP_NEXT still has to drop, per task
+    TimelineInterval run = {IDLE_TASK, 0, 0}; // current run, not yet pushed to the sink
+    int previousTask = -1; // index of the task that ran last, kept through idle time for tie-breaks
+    long long previousRelease = 0; // release of the job that ran last
+    long long dispatched = 0;      // when that job last took the processor
+    long long preemptions = 0;
+    vector<ResponseStatistics> responses; // per task, over the jobs completed so far
+    // releases in time order shared by several simulations (see PolicyComparison); when set,
+    // jobs are released from it instead of from nextRelease
+    const vector<ReleaseEvent> *releases = nullptr;
+    size_t releaseCursor = 0;
+    vector<DeadlineMiss> misses;
+    bool stopped = false; // stopped at the first miss
+    bool recordsJobs = false;
+    vector<JobRecord> jobs; // every job released so far, when recordsJobs
+};
+
+// Outcome of simulating until the schedule repeats
+struct FeasibilityResult
+{
+    bool steady = false;     // false when no repetition was found within the limit
+    long long cycleStart = 0; // hyperperiod boundary from which the schedule repeats
+    long long cycleLength = 0;
+    long long simulated = 0;  // ticks simulated
+    vector<DeadlineMiss> misses;
+};
+
+// All simulation state lives in the instance, so separate Schedulers can simulate on separate
+// threads. Their progress messages still share cout, and rendering is not covered.
 class Scheduler
 {
+    friend class PolicyComparison;
+
 public:
     Scheduler(); // Default constructor
     Scheduler(const std::vector<Task> &tasks, int choice = CHOICE);
 
     bool runRMDMTest(std::vector<Task> taskSet);
+    // Worst-case response time of task over every job in its level-i busy period, with higher
+    // being the tasks of higher priority. Stops early once it exceeds limit; LLONG_MAX when the
+    // level is overloaded.
+    long long computeResponseTime(const Task &task, const std::vector<Task> &higher, long long limit = LLONG_MAX) const;
     bool runEDFLSTTest();
     bool runOPA();
+    // Rate monotonic for RM, deadline monotonic otherwise
     void setPriority();
-    void generateTimeline();
+    // Gives every task a priority from n (first in the order) down to 1, in O(n log n)
+    void setPriority(int order);
+    // MISS_CONTINUE, MISS_ABORT or MISS_SKIP_NEXT. With stopAtFirstMiss the simulation ends
+    // as soon as a deadline is missed, which makes it a cheap rejection test for batches.
+    void setMissPolicy(int policy, bool stopAtFirstMiss = false);
+    // With threads > 1 generateTimeline cuts the horizon at idle instants, simulates the pieces
+    // concurrently and stitches them, holding every piece in memory until then. Only used while
+    // late jobs run on and the simulation does not stop at a miss.
+    void setThreadCount(int threads);
+    // Times within [0, horizon) at which the synchronous schedule has no pending work left,
+    // found from the demand of every busy period without simulating it
+    std::vector<long long> computeIdleInstants(long long horizon) const;
+    // LST only: a job keeps the processor for at least ticks ticks (or until it completes)
+    // before a job of lower laxity can take over, which stops equal-laxity jobs thrashing
+    void setMinimumQuantum(long long ticks);
+    // Simulates horizon ticks into timeline, one hyperperiod when horizon == 0.
+    // Returns false if a deadline was missed.
+    bool generateTimeline(long long horizon = 0);
+    // Pushes the schedule into the sink as runs of one task.
+    // horizon == 0 simulates one hyperperiod.
+    bool generateTimeline(TimelineSink &sink, long long horizon = 0);
+    // Simulates hyperperiod after hyperperiod until the backlog at a boundary repeats an
+    // earlier one, so the schedule from there on is periodic. Gives up after maxHyperperiods.
+    FeasibilityResult simulateFeasibilityInterval(TimelineSink &sink, int maxHyperperiods = 64);
+    // Misses of the last simulation
+    const std::vector<DeadlineMiss> &getDeadlineMisses() const;
+    // Jobs released by the last generateTimeline into timeline, in release order. Streaming
+    // simulations keep none, so their memory does not grow with the horizon.
+    const std::vector<JobRecord> &getJobs() const;
+    // Jobs of the last simulation that lost the processor before completing
+    long long getPreemptionCount() const;
+    // Per task in task order, over the jobs completed in the last simulation
+    const std::vector<ResponseStatistics> &getResponseStatistics() const;
+    // Response-time analysis bound of the task under the current fixed priorities, -1 under
+    // EDF and LST; LLONG_MAX when its level is overloaded
+    long long computeResponseBound(const Task &task) const;
+    // Observed response times of the last simulation next to the analytic bounds
+    void displayResponseStatistics(std::ostream &out = std::cout) const;
     double computeUtilization() const;
     int computeHyperperiod() const;
 
     void displayTimeline();
+    // Headless alternative to displayTimeline: writes <prefix>_<n>.png tiles, returns how many
+    int renderTimeline(const std::string &prefix, int stepsPerImage = 1000);
+    // Simulates horizon ticks (one hyperperiod when 0) straight into a Chrome trace-event JSON
+    // file, without keeping the timeline; returns false if the file can't be written
+    bool exportTrace(const std::string &path, long long horizon = 0);
 
     std::vector<Task> tasks_;
-	std::vector<string> timeline;
+    std::vector<TimelineInterval> timeline; // runs of one task in time order
 
 private:
+    SimulationState startSimulation(bool recordsJobs = false) const;
+    bool simulate(TimelineSink &sink, long long horizon, bool recordsJobs);
+    // Simulates up to time until, pushing finished runs into the sink
+    void advance(SimulationState &state, long long until, TimelineSink &sink) const;
+    void finishSimulation(SimulationState &state, TimelineSink &sink);
+    // Applies the miss policy to jobs whose deadline is at or before the state's time
+    void checkDeadlines(SimulationState &state, TimelineSink &sink) const;
+    void releaseJobs(SimulationState &state, TimelineSink &sink) const;
+    // Index of the task whose oldest job runs next under the policy, -1 to idle
+    int selectTask(const SimulationState &state) const;
+    // Runs the oldest job of task (idles if -1) for ticks ticks
+    void runFor(SimulationState &state, int task, long long ticks, TimelineSink &sink) const;
+    // advance for LST, jumping between the instants at which the schedule can change
+    void advanceLaxityEvents(SimulationState &state, long long until, TimelineSink &sink) const;
+    void generateInParallel(TimelineSink &sink, long long horizon, bool recordsJobs);
+
     // std::vector<Task> tasks_;
     int choice_;
+    int missPolicy_ = MISS_CONTINUE;
+    bool stopAtFirstMiss_ = false;
+    int threads_ = 1;
+    long long quantum_ = 1;
+    std::vector<DeadlineMiss> misses_;
+    std::vector<JobRecord> jobs_;
+    long long preemptions_ = 0;
+    std::vector<ResponseStatistics> responses_;
 };
 
 
@@ -71,15 +287,25 @@ struct Resource {
     int id;
     int ceilingPriority = 0;
     bool isHeld = false;
-    int heldBy;
+    int heldBy = 0;
 };
 
 struct ResourceRequest {
 	int id;
 	int duration;
-    bool isFinished = false;
+    vector<ResourceRequest> nested; // sections entered while this one is held
 };
 
+// A critical section laid out on the job's execution time: the resource is held
+// from when the job has executed `start` units until it has executed `end` units
+struct CriticalSection {
+    int resourceId;
+    int start;
+    int end;
+};
+
+// releaseTime and deadline are measured from the start of the job's period frame,
+// so instance k is released at k * period + releaseTime and is due at k * period + deadline
 struct Job
 {
     int id;
@@ -95,33 +321,87 @@ struct Job
     bool isBlocked = false;
     bool isFinished = false;
     int waitingFor;
+    int instance = 0;
+
+    vector<CriticalSection> sections; // resourceSequence flattened in pre-order
+    int nextSection = 0;
+    vector<int> lockStack;     // indices into sections of the locks currently held
+    vector<int> savedPriority; // priority to restore when the matching lock is released
+
+    int stackSize = 0;        // stack frame size, used for the shared SRP execution stack
+    int preemptionLevel = 0;  // SRP preemption level, higher for shorter relative deadlines
+};
+
+// Top-level sections run back to back from the start of the job. Nested sections start
+// one unit into their parent and also run back to back, so they are released in LIFO order.
+vector<CriticalSection> flattenCriticalSections(const Job& job);
+
+// Deadline measured from the job's release
+int relativeDeadline(const Job& job);
+// Ranks the distinct relative deadlines so the shortest one gets the highest preemption level
+void assignPreemptionLevels(vector<Job>& jobs);
+
+// A span during which a job held a resource, preemptions included
+struct ResourceHold {
+    int resourceId;
+    int holder;
+    int start;
+    int end; // -1 while still held
 };
 
 struct simulate {
-    string job;
-	vector<Resource> resource;
+    int jobId;
     int time;
+    int priority; // the job's current priority while it ran, including any inherited boost
 };
 
+// Like Scheduler, instances share no state and can simulate concurrently
 class Inheritance {
-    vector<Job> jobs;
+    vector<Job> templates; // periodic job templates as given by the caller
+    vector<Job> jobs;      // one recycled record per template, reset on every release
     vector<Resource> resources;
 	vector<simulate> timeline;
+    vector<ResourceHold> holds; // in lock order, reserved up front for every lock the run can take
+    vector<int> openHold;       // resource id - 1 -> its span in holds while locked
 	int numOfResource;
     int time = 0;
+    unordered_map<int, size_t> jobIndex; // job id -> position in jobs
+    // {ceiling, resource id} of every locked resource, highest ceiling first
+    multiset<pair<int, int>, greater<pair<int, int>>> lockedCeilings;
+    // SRP: jobs that have started and not finished, sharing one LIFO execution stack
+    vector<int> executionStack;
+    int stackUsage = 0;
+    int peakStackUsage = 0;
 
 public:
-    Inheritance(vector<Job>& taskList, int numOfResource, int choice = CHOICE);
+    // horizon == 0 runs every job once; otherwise jobs are released periodically until time reaches horizon
+    Inheritance(vector<Job>& taskList, int numOfResource, int choice = CHOICE, int horizon = 0);
+    // Throws logic_error if an SRP job finishes while it is not on top of the shared stack
     void simulateResource();
     bool allTasksFinished();
+    int computeHyperperiod() const;
+    void releaseJob(Job& job, const Job& jobTemplate, int instance);
     void updateResourceUsage(Job& job);
     Job* getNextRunnableTask();
     void runTask(Job& t);
     Job& getTaskById(const int& id);
 	Resource& getResourceById(const int& id);
+    void lockResource(Resource& resource, const Job& job);
+    void unlockResource(Resource& resource);
+    Resource* getCeilingResource(const Job& job);
+    const vector<Job>& getJobTemplates() const;
+    const vector<Resource>& getResources() const;
+    const vector<simulate>& getTimeline() const;
+    const vector<ResourceHold>& getResourceHolds() const;
+    int getPeakStackUsage() const;
+    int getChoice() const;
+    int getHorizon() const;
     void displayTimeline();
+    int renderTimeline(const std::string& prefix, int stepsPerImage = 1000);
+    bool exportTrace(const std::string& path) const;
 private:
     int choice_;
+    int horizon_;
 };
 
 #endif // SCHEDULER_H
@@ -0,0 +1,350 @@
+#include "task_file.hpp"
+#include "instrumentation.hpp"
+#include <sstream>
+
+// Just enough JSON for one task per line: objects, arrays, integers and strings
+struct JsonValue
+{
+    enum Type { Null, Number, String, Array, Object } type = Null;
+    long long number = 0;
+    string text;
+    vector<JsonValue> items;
+    map<string, JsonValue> fields;
+};
+
+class JsonParser
+{
+public:
+    explicit JsonParser(const string &text) : text(text) {}
+
+    JsonValue parseDocument()
+    {
+        JsonValue value = parseValue();
+        skipSpace();
+        if (pos != text.size())
+            fail("trailing characters");
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const string &reason)
+    {
+        throw runtime_error("invalid JSON at column " + to_string(pos + 1) + ": " + reason);
+    }
+
+    void skipSpace()
+    {
+        while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos])))
+            pos++;
+    }
+
+    void expect(char c)
+    {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != c)
+            fail(string("expected '") + c + "'");
+        pos++;
+    }
+
+    bool accept(char c)
+    {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c)
+        {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    string parseString()
+    {
+        expect('"');
+        string value;
+        while (pos < text.size() && text[pos] != '"')
+        {
+            if (text[pos] == '\\' && pos + 1 < text.size())
+                pos++;
+            value += text[pos++];
+        }
+        expect('"');
+        return value;
+    }
+
+    JsonValue parseValue()
+    {
+        JsonValue value;
+        skipSpace();
+        if (pos >= text.size())
+            fail("unexpected end of line");
+        char c = text[pos];
+        if (c == '{')
+        {
+            value.type = JsonValue::Object;
+            pos++;
+            if (accept('}'))
+                return value;
+            do
+            {
+                skipSpace();
+                string key = parseString();
+                expect(':');
+                value.fields[key] = parseValue();
+            } while (accept(','));
+            expect('}');
+        }
+        else if (c == '[')
+        {
+            value.type = JsonValue::Array;
+            pos++;
+            if (accept(']'))
+                return value;
+            do
+                value.items.push_back(parseValue());
+            while (accept(','));
+            expect(']');
+        }
+        else if (c == '"')
+        {
+            value.type = JsonValue::String;
+            value.text = parseString();
+        }
+        else if (text.compare(pos, 4, "null") == 0)
+            pos += 4;
+        else
+        {
+            size_t used = 0;
+            try
+            {
+                value.number = stoll(text.substr(pos), &used);
+            }
+            catch (const exception &)
+            {
+                fail("expected a value");
+            }
+            value.type = JsonValue::Number;
+            pos += used;
+        }
+        return value;
+    }
+
+    const string &text;
+    size_t pos = 0;
+};
+
+static int field(const JsonValue &object, const string &name, bool required = true, int fallback = 0)
+{
+    auto it = object.fields.find(name);
+    if (it == object.fields.end() || it->second.type == JsonValue::Null)
+    {
+        if (required)
+            throw runtime_error("missing field \"" + name + "\"");
+        return fallback;
+    }
+    if (it->second.type != JsonValue::Number)
+        throw runtime_error("field \"" + name + "\" is not a number");
+    if (it->second.number < INT_MIN || it->second.number > INT_MAX)
+        throw runtime_error("field \"" + name + "\" is out of range");
+    return static_cast<int>(it->second.number);
+}
+
+static vector<ResourceRequest> jsonSections(const JsonValue &sections)
+{
+    if (sections.type == JsonValue::Null)
+        return {};
+    if (sections.type != JsonValue::Array)
+        throw runtime_error("\"sections\" is not an array");
+    vector<ResourceRequest> requests;
+    for (const auto &section : sections.items)
+    {
+        auto nested = section.fields.find("nested");
+        requests.push_back({field(section, "resource"), field(section, "duration"),
+                            nested == section.fields.end() ? vector<ResourceRequest>() : jsonSections(nested->second)});
+    }
+    return requests;
+}
+
+static int csvNumber(const string &text)
+{
+    size_t used = 0;
+    int value = 0;
+    try
+    {
+        value = stoi(text, &used);
+    }
+    catch (const out_of_range &)
+    {
+        throw runtime_error("\"" + text + "\" is out of range");
+    }
+    catch (const exception &)
+    {
+        used = 0;
+    }
+    while (used < text.size() && isspace(static_cast<unsigned char>(text[used])))
+        used++;
+    if (used == 0 || used != text.size())
+        throw runtime_error("\"" + text + "\" is not a number");
+    return value;
+}
+
+// "1:4(2:2);2:1"
+static vector<ResourceRequest> csvSections(const string &text, size_t &pos)
+{
+    vector<ResourceRequest> requests;
+    while (pos < text.size() && text[pos] != ')')
+    {
+        if (text[pos] == ';' || isspace(static_cast<unsigned char>(text[pos])))
+        {
+            pos++;
+            continue;
+        }
+        size_t colon = text.find(':', pos);
+        if (colon == string::npos)
+            throw runtime_error("section \"" + text.substr(pos) + "\" has no duration");
+        size_t end = text.find_first_of(";()", colon);
+        if (end == string::npos)
+            end = text.size();
+        ResourceRequest request = {csvNumber(text.substr(pos, colon - pos)), csvNumber(text.substr(colon + 1, end - colon - 1)), {}};
+        pos = end;
+        if (pos < text.size() && text[pos] == '(')
+        {
+            pos++;
+            request.nested = csvSections(text, pos);
+            if (pos >= text.size() || text[pos] != ')')
+                throw runtime_error("unbalanced parentheses in \"" + text + "\"");
+            pos++;
+        }
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+static vector<string> csvFields(const string &line)
+{
+    vector<string> fields;
+    stringstream stream(line);
+    string field;
+    while (getline(stream, field, ','))
+        fields.push_back(field);
+    return fields;
+}
+
+void checkTiming(long long WCET, long long period, long long deadline)
+{
+    if (WCET <= 0)
+        throw runtime_error("WCET must be positive");
+    if (period <= 0)
+        throw runtime_error("period must be positive");
+    if (deadline <= 0)
+        throw runtime_error("deadline must be positive");
+}
+
+// Calls parse on every line that holds a record, prefixing its errors with the line number
+template <typename Parse>
+static void forEachRecord(istream &in, int format, Parse parse)
+{
+    string line;
+    int number = 0;
+    while (getline(in, line))
+    {
+        number++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#')
+            continue;
+        // a CSV header starts with a name rather than an id
+        if (format == TASK_FORMAT_CSV && number == 1 && !isdigit(static_cast<unsigned char>(line[first])))
+            continue;
+        try
+        {
+            parse(line);
+        }
+        catch (const exception &error)
+        {
+            throw runtime_error("line " + to_string(number) + ": " + error.what());
+        }
+    }
+}
+
+vector<Task> readTasks(istream &in, int format)
+{
+    INSTRUMENT_PHASE(PHASE_PARSE);
+    vector<Task> tasks;
+    forEachRecord(in, format, [&](const string &line) {
+        if (format == TASK_FORMAT_JSONL)
+        {
+            JsonValue task = JsonParser(line).parseDocument();
+            tasks.push_back({field(task, "id"), field(task, "wcet"), field(task, "period"), field(task, "deadline"), 0});
+        }
+        else
+        {
+            vector<string> fields = csvFields(line);
+            if (fields.size() != 4)
+                throw runtime_error("expected id,WCET,period,deadline");
+            tasks.push_back({csvNumber(fields[0]), csvNumber(fields[1]), csvNumber(fields[2]), csvNumber(fields[3]), 0});
+        }
+        checkTiming(tasks.back().WCET, tasks.back().period, tasks.back().deadline);
+    });
+    return tasks;
+}
+
+vector<Job> readJobs(istream &in, int format)
+{
+    INSTRUMENT_PHASE(PHASE_PARSE);
+    vector<Job> jobs;
+    forEachRecord(in, format, [&](const string &line) {
+        Job job{};
+        if (format == TASK_FORMAT_JSONL)
+        {
+            JsonValue value = JsonParser(line).parseDocument();
+            job.id = field(value, "id");
+            job.releaseTime = field(value, "release", false);
+            job.WCET = field(value, "wcet");
+            job.basePriority = field(value, "priority", false);
+            job.period = field(value, "period");
+            job.deadline = field(value, "deadline");
+            auto sections = value.fields.find("sections");
+            if (sections != value.fields.end())
+                job.resourceSequence = jsonSections(sections->second);
+            job.stackSize = field(value, "stack", false);
+        }
+        else
+        {
+            vector<string> fields = csvFields(line);
+            if (fields.size() < 6 || fields.size() > 8)
+                throw runtime_error("expected id,release,WCET,priority,period,deadline,sections[,stack]");
+            job.id = csvNumber(fields[0]);
+            job.releaseTime = csvNumber(fields[1]);
+            job.WCET = csvNumber(fields[2]);
+            job.basePriority = csvNumber(fields[3]);
+            job.period = csvNumber(fields[4]);
+            job.deadline = csvNumber(fields[5]);
+            size_t pos = 0;
+            if (fields.size() > 6)
+                job.resourceSequence = csvSections(fields[6], pos);
+            if (fields.size() > 6 && pos != fields[6].size())
+                throw runtime_error("unbalanced parentheses in \"" + fields[6] + "\"");
+            if (fields.size() > 7)
+                job.stackSize = csvNumber(fields[7]);
+        }
+        // a job's deadline is absolute
+        checkTiming(job.WCET, job.period, static_cast<long long>(job.deadline) - job.releaseTime);
+        jobs.push_back(job);
+    });
+    return jobs;
+}
+
+static int maxResourceId(const vector<ResourceRequest> &requests)
+{
+    int highest = 0;
+    for (const auto &request : requests)
+        highest = max({highest, request.id, maxResourceId(request.nested)});
+    return highest;
+}
+
+int countResources(const vector<Job> &jobs)
+{
+    int highest = 0;
+    for (const auto &job : jobs)
+        highest = max(highest, maxResourceId(job.resourceSequence));
+    return highest;
+}
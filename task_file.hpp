@@ -0,0 +1,32 @@
+// Task set files for the command-line mode, one task per line in either format:
+//
+// CSV, where blank lines, '#' comments and a header line are skipped
+//   id,WCET,period,deadline                                     for RM, DM, EDF, LST and OPA
+//   id,release,WCET,priority,period,deadline,sections[,stack]   for PIP, OCPP, ICPP and SRP
+// sections are "resource:duration" entries separated by ';', each optionally followed by
+// its nested sections in parentheses, e.g. "1:4(2:2);2:1"
+//
+// JSON lines, one object per line with the same fields in lowercase:
+//   {"id":1,"wcet":4,"period":20,"deadline":20}
+//   {"id":1,"release":0,"wcet":4,"priority":2,"period":20,"deadline":20,
+//    "sections":[{"resource":1,"duration":4,"nested":[{"resource":2,"duration":2}]}],"stack":0}
+#ifndef TASK_FILE_HPP
+#define TASK_FILE_HPP
+#include "scheduler.hpp"
+
+#define TASK_FORMAT_CSV 0
+#define TASK_FORMAT_JSONL 1
+
+// Both throw runtime_error naming the offending line, also when a number does not fit an int
+// or a WCET, period or relative deadline is not positive
+vector<Task> readTasks(istream &in, int format);
+vector<Job> readJobs(istream &in, int format);
+
+// Throws runtime_error unless WCET, period and relative deadline are all positive; the
+// simulators and analyses divide by the period and assume every job does some work
+void checkTiming(long long WCET, long long period, long long deadline);
+
+// Highest resource id used by any critical section, nested ones included
+int countResources(const vector<Job> &jobs);
+
+#endif // TASK_FILE_HPP
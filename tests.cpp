@@ -1,6 +1,21 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 #include "scheduler.hpp"
+#include "analysis.hpp"
+#include "trace.hpp"
+#include "timeline_sink.hpp"
+#include "schedule_file.hpp"
+#include "timeline_query.hpp"
+#include "task_file.hpp"
+#include "cli.hpp"
+#include "corpus.hpp"
+#include "corpus_file.hpp"
+#include "comparison.hpp"
+#include "instrumentation.hpp"
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <sstream>
 using namespace std;
 
 TEST_CASE("Scheduler Tests RM")
@@ -17,7 +32,9 @@ TEST_CASE("Scheduler Tests RM")
     REQUIRE(scheduler.runRMDMTest(scheduler.tasks_) == true);
    
     scheduler.generateTimeline();
-    scheduler.displayTimeline();
+    REQUIRE(scheduler.renderTimeline("rm") == 1);
+    // 400 steps over tiles of 150
+    REQUIRE(scheduler.renderTimeline("rm_tiled", 150) == 3);
 
 }
 TEST_CASE("Scheduler Tests DM")
@@ -34,7 +51,7 @@ TEST_CASE("Scheduler Tests DM")
     REQUIRE(utilization == Approx(0.909).epsilon(0.01));
     REQUIRE(scheduler.runRMDMTest(scheduler.tasks_) == true);
     scheduler.generateTimeline();
-    scheduler.displayTimeline();
+    REQUIRE(scheduler.renderTimeline("dm") == 1);
 }
 
 TEST_CASE("Scheduler Tests EDF")
@@ -54,14 +71,14 @@ TEST_CASE("Scheduler Tests EDF")
     REQUIRE(utilization == Approx(0.897).epsilon(0.01));
     REQUIRE(scheduler.runEDFLSTTest() == true);
     scheduler.generateTimeline();
-    scheduler.displayTimeline();
+    REQUIRE(scheduler.renderTimeline("edf") == 1);
 
     Scheduler scheduler2(tasks2, CHOICE_EDF);
     double utilization2 = scheduler2.computeUtilization();
     REQUIRE(utilization2 == Approx(1.058).epsilon(0.01));
     REQUIRE(scheduler2.runEDFLSTTest() == true);
     scheduler2.generateTimeline();
-    scheduler2.displayTimeline();
+    REQUIRE(scheduler2.renderTimeline("edf2") == 1);
 }
 
 TEST_CASE("Scheduler Tests LST")
@@ -79,27 +96,134 @@ TEST_CASE("Scheduler Tests LST")
     REQUIRE(scheduler.runEDFLSTTest() == true);
 
     scheduler.generateTimeline();
-    scheduler.displayTimeline();
+    REQUIRE(scheduler.renderTimeline("lst") == 1);
 }
 
 TEST_CASE("Scheduler Tests PIP")
 {
 	cout << "Testing PIP\n";
     int numOfResources = 2;
-    // id, release time, WCET, priority, period, deadline, {id,duration}
+    // id, release time, WCET, priority, period, deadline, {id,duration, nested}
     vector<Job> taskList = {
 
        {1, 10, 4, 5, 23, 23, {{1, 3}}},
        {2, 8,  3, 4, 23, 23, {{2, 2}}},
        {3, 6,  3, 3, 23, 23, {{1, 2}}},
-       {4, 3,  7, 2, 23, 23, {{1, 4}, {2, 2}}},
+       {4, 3,  7, 2, 23, 23, {{1, 4, {{2, 2}}}}},
        {5, 0,  6, 1, 23, 23, {{2, 3}}}
     };
 
 
     Inheritance Inheritance(taskList, numOfResources, CHOICE_PIP);
     Inheritance.simulateResource();
-    Inheritance.displayTimeline();
+    REQUIRE(Inheritance.renderTimeline("pip") == 1);
+}
+
+TEST_CASE("Scheduler Tests PIP Periodic")
+{
+	cout << "Testing PIP over two periods\n";
+    int numOfResources = 2;
+    // id, release time, WCET, priority, period, deadline, {id,duration, nested}
+    vector<Job> taskList = {
+
+       {1, 10, 4, 5, 23, 23, {{1, 3}}},
+       {2, 8,  3, 4, 23, 23, {{2, 2}}},
+       {3, 6,  3, 3, 23, 23, {{1, 2}}},
+       {4, 3,  7, 2, 23, 23, {{1, 4, {{2, 2}}}}},
+       {5, 0,  6, 1, 23, 23, {{2, 3}}}
+    };
+
+    Inheritance Inheritance(taskList, numOfResources, CHOICE_PIP, 2 * 23);
+    REQUIRE(Inheritance.computeHyperperiod() == 23);
+    size_t holdCapacity = Inheritance.getResourceHolds().capacity();
+    Inheritance.simulateResource();
+    REQUIRE(Inheritance.allTasksFinished());
+    // two instances of six sections each, recorded without growing the reserved spans
+    REQUIRE(Inheritance.getResourceHolds().size() == 12);
+    REQUIRE(Inheritance.getResourceHolds().capacity() == holdCapacity);
+    ostringstream trace;
+    exportTrace(Inheritance, trace);
+    REQUIRE(trace.str().find("{\"name\":\"release\",\"ph\":\"i\",\"pid\":1,\"ts\":33,\"cat\":\"job\",\"tid\":101") != string::npos);
+}
+
+TEST_CASE("Scheduler Tests PIP Offset")
+{
+    // T1, released at 10, is preempted by T2 and still runs at 24, past 23 but within its own
+    // period; its second job, released at 33, runs 33-35 and 38-48
+    vector<Job> offset = {
+       {1, 10, 12, 1, 23, 33, {}},
+       {2, 12, 3, 2, 23, 35, {}}
+    };
+    Inheritance offsetRun(offset, 1, CHOICE_PIP, 50);
+    offsetRun.simulateResource();
+    REQUIRE(offsetRun.allTasksFinished());
+    vector<long long> secondJob;
+    for (const auto &entry : offsetRun.getTimeline())
+    {
+        if (entry.jobId == 1 && entry.time >= 33)
+            secondJob.push_back(entry.time);
+    }
+    REQUIRE(secondJob.size() == 12);
+    REQUIRE(secondJob.front() == 33);
+    REQUIRE(secondJob[2] == 38);
+    REQUIRE(secondJob.back() == 47);
+}
+
+TEST_CASE("Trace Export")
+{
+    vector<Task> tasks = {
+        {1, 1, 4, 4},
+        {2, 2, 6, 6}};
+    Scheduler scheduler(tasks, CHOICE_RM);
+    scheduler.setPriority();
+
+    ostringstream out;
+    exportTrace(scheduler, out);
+    string trace = out.str();
+    REQUIRE(trace.rfind("{\"traceEvents\":[", 0) == 0);
+    REQUIRE(trace.substr(trace.size() - 4) == "\n]}\n");
+    // T1 runs [0,1) and T2 [1,3); both meet every deadline
+    REQUIRE(trace.find("{\"name\":\"T1\",\"ph\":\"X\",\"pid\":1,\"ts\":0,\"cat\":\"task\",\"tid\":1,\"dur\":1}") != string::npos);
+    REQUIRE(trace.find("{\"name\":\"T2\",\"ph\":\"X\",\"pid\":1,\"ts\":1,\"cat\":\"task\",\"tid\":1,\"dur\":2}") != string::npos);
+    REQUIRE(trace.find("deadline miss") == string::npos);
+
+    // MISS_SKIP_NEXT drops the release of T2 at 6, so its next deadline is 18, not 12
+    vector<Task> late = {
+        {1, 2, 4, 4, 2},
+        {2, 3, 6, 6, 1}};
+    Scheduler skipped(late, CHOICE_ARB_DEADLINE);
+    skipped.setMissPolicy(MISS_SKIP_NEXT);
+    out.str("");
+    exportTrace(skipped, out);
+    trace = out.str();
+    REQUIRE(trace.find("{\"name\":\"deadline miss\",\"ph\":\"i\",\"pid\":1,\"ts\":6,\"cat\":\"job\",\"tid\":102") != string::npos);
+    REQUIRE(trace.find("deadline miss", trace.find("deadline miss") + 1) == string::npos);
+    REQUIRE(trace.find("{\"name\":\"release\",\"ph\":\"i\",\"pid\":1,\"ts\":6,\"cat\":\"job\",\"tid\":102") == string::npos);
+    REQUIRE(trace.find("{\"name\":\"deadline\",\"ph\":\"i\",\"pid\":1,\"ts\":12,\"cat\":\"job\",\"tid\":102") == string::npos);
+    REQUIRE(trace.find("{\"name\":\"release\",\"ph\":\"i\",\"pid\":1,\"ts\":8,\"cat\":\"job\",\"tid\":101") != string::npos);
+
+    // streamed from parallel segments, the events come out in the same order as from one simulation
+    out.str("");
+    exportTrace(scheduler, out, 1200);
+    string sequential = out.str();
+    scheduler.setThreadCount(4);
+    out.str("");
+    exportTrace(scheduler, out, 1200);
+    REQUIRE(out.str() == sequential);
+    REQUIRE(scheduler.timeline.empty());
+
+    int numOfResources = 1;
+    vector<Job> taskList = {
+        {1, 1, 2, 2, 10, 10, {{1, 1}}},
+        {2, 0, 3, 1, 10, 10, {{1, 2}}}};
+    Inheritance inheritance(taskList, numOfResources, CHOICE_PIP);
+    inheritance.simulateResource();
+    out.str("");
+    exportTrace(inheritance, out);
+    trace = out.str();
+    // T2 holds R1 over [0,2) and inherits priority 2 once T1 blocks on it at time 1
+    REQUIRE(trace.find("{\"name\":\"T2\",\"ph\":\"X\",\"pid\":1,\"ts\":0,\"cat\":\"lock\",\"tid\":10001,\"dur\":2}") != string::npos);
+    REQUIRE(trace.find("{\"name\":\"T2 priority\",\"ph\":\"C\",\"pid\":1,\"ts\":1,\"args\":{\"value\":2}}") != string::npos);
 }
 
 TEST_CASE("Scheduler Tests ICPP")
@@ -112,13 +236,13 @@ TEST_CASE("Scheduler Tests ICPP")
        {1, 10, 4, 5, 23, 23, {{1, 3}}},
        {2, 8,  3, 4, 23, 23, {{2, 2}}},
        {3, 6,  3, 3, 23, 23, {{1, 2}}},
-       {4, 3,  7, 2, 23, 23, {{1, 4}, {2, 2}}},
+       {4, 3,  7, 2, 23, 23, {{1, 4, {{2, 2}}}}},
        {5, 0,  6, 1, 23, 23, {{2, 3}}}
     };
 
     Inheritance Inheritance(taskList, numOfResources, CHOICE_ICPP);
     Inheritance.simulateResource();
-    Inheritance.displayTimeline();
+    REQUIRE(Inheritance.renderTimeline("icpp") == 1);
 }
 
 
@@ -130,14 +254,14 @@ TEST_CASE("Scheduler Tests OCPP") {
        {1, 10, 4, 5, 23, 23, {{1, 3}}},
        {2, 8,  3, 4, 23, 23, {{2, 2}}},
        {3, 6,  3, 3, 23, 23, {{2, 2}}},
-       {4, 3,  7, 2, 23, 23, {{1, 4}, {2, 2}}},
+       {4, 3,  7, 2, 23, 23, {{1, 4, {{2, 2}}}}},
        {5, 0,  6, 1, 23, 23, {{2, 3}}}
     };
 
 
     Inheritance Inheritance(taskList, numOfResources, CHOICE_OCPP);
     Inheritance.simulateResource();
-    Inheritance.displayTimeline();
+    REQUIRE(Inheritance.renderTimeline("ocpp") == 1);
 }
 
 TEST_CASE("Scheduler Tests OCPP2") {
@@ -148,14 +272,114 @@ TEST_CASE("Scheduler Tests OCPP2") {
        {1, 10, 4, 5, 23, 23, {{1, 3}}},
        {2, 8,  3, 4, 23, 23, {{2, 2}}},
        {3, 6,  3, 3, 23, 23, {{1, 2}}},
-       {4, 3,  7, 2, 23, 23, {{1, 4}, {2, 2}}},
+       {4, 3,  7, 2, 23, 23, {{1, 4, {{2, 2}}}}},
        {5, 0,  6, 1, 23, 23, {{2, 5}}}
     };
 
 
     Inheritance Inheritance(taskList, numOfResources, CHOICE_OCPP);
     Inheritance.simulateResource();
-    Inheritance.displayTimeline();
+    REQUIRE(Inheritance.allTasksFinished());
+    REQUIRE(Inheritance.renderTimeline("ocpp2") == 1);
+}
+
+TEST_CASE("Scheduler Tests PIP Nested")
+{
+	cout << "Testing PIP with nested critical sections\n";
+    int numOfResources = 2;
+    // T3 holds R1 over [0,5) and R2 over [1,3) of its execution; T1 blocks on R1 at time 2
+    // id, release time, WCET, priority, period, deadline, {id,duration, nested}
+    vector<Job> taskList = {
+       {1, 2, 2, 3, 20, 20, {{1, 1}}},
+       {2, 3, 4, 2, 20, 20, {}},
+       {3, 0, 6, 1, 20, 20, {{1, 5, {{2, 2}}}}}
+    };
+
+    Inheritance inheritance(taskList, numOfResources, CHOICE_PIP);
+    inheritance.simulateResource();
+    REQUIRE(inheritance.allTasksFinished());
+
+    // releasing the inner R2 at time 3 must not drop the priority T3 inherited through R1
+    const vector<simulate>& timeline = inheritance.getTimeline();
+    REQUIRE(timeline[3].jobId == 3);
+    REQUIRE(timeline[4].jobId == 3);
+    REQUIRE(timeline[5].jobId == 1);
+
+    taskList[2].resourceSequence[0].nested[0].duration = 5;
+    REQUIRE_THROWS(Inheritance(taskList, numOfResources, CHOICE_PIP));
+}
+
+TEST_CASE("Scheduler Tests SRP")
+{
+	cout << "Testing EDF with SRP\n";
+    int numOfResources = 1;
+    // id, release time, WCET, priority, period, deadline, {id,duration, nested}
+    vector<Job> taskList = {
+       {1, 2, 2, 0, 20, 8,  {{1, 1}}},
+       {2, 1, 3, 0, 20, 12, {}},
+       {3, 0, 4, 0, 20, 20, {{1, 3}}}
+    };
+    taskList[0].stackSize = 10;
+    taskList[1].stackSize = 20;
+    taskList[2].stackSize = 30;
+
+    Inheritance inheritance(taskList, numOfResources, CHOICE_SRP);
+    BlockingAnalysis analysis(inheritance);
+    REQUIRE(analysis.computeBlockingTime(taskList[0]) == 3);
+    REQUIRE(analysis.computeBlockingTime(taskList[1]) == 3);
+    REQUIRE(analysis.computeBlockingTime(taskList[2]) == 0);
+    REQUIRE(analysis.runSRPDemandTest() == true);
+    // SRP jobs are scheduled by EDF, so fixed-priority RTA over the base priorities is refused
+    REQUIRE_THROWS_WITH(analysis.runRTATest(), Catch::Contains("SRP demand test"));
+    REQUIRE_THROWS(analysis.computeResponseTime(taskList[0]));
+
+    inheritance.simulateResource();
+    REQUIRE(inheritance.allTasksFinished());
+
+    // T2 and T1 may not start while T3 holds R1, whose ceiling is T1's preemption level
+    vector<int> expected = {3, 3, 3, 1, 1, 2, 2, 2, 3};
+    const vector<simulate>& timeline = inheritance.getTimeline();
+    for (size_t i = 0; i < expected.size(); ++i)
+        REQUIRE(timeline[i].jobId == expected[i]);
+    REQUIRE(inheritance.getPeakStackUsage() == 50);
+
+    // a 4 unit relative deadline for T1 cannot absorb the 3 unit blocking
+    taskList[0].deadline = 6;
+    Inheritance tight(taskList, numOfResources, CHOICE_SRP);
+    REQUIRE(BlockingAnalysis(tight).runSRPDemandTest() == false);
+}
+
+TEST_CASE("Blocking Analysis PIP and ICPP")
+{
+    int numOfResources = 2;
+    // id, release time, WCET, priority, period, deadline, {id,duration, nested}
+    vector<Job> taskList = {
+       {1, 10, 4, 5, 23, 23, {{1, 3}}},
+       {2, 8,  3, 4, 23, 23, {{2, 2}}},
+       {3, 6,  3, 3, 23, 23, {{1, 2}}},
+       {4, 3,  7, 2, 23, 23, {{1, 4, {{2, 2}}}}},
+       {5, 0,  6, 1, 23, 23, {{2, 3}}}
+    };
+
+    Inheritance pip(taskList, numOfResources, CHOICE_PIP);
+    BlockingAnalysis pipAnalysis(pip);
+    vector<int> pipBlocking = {4, 7, 7, 3, 0};
+    for (size_t i = 0; i < taskList.size(); ++i)
+        REQUIRE(pipAnalysis.computeBlockingTime(taskList[i]) == pipBlocking[i]);
+    REQUIRE(pipAnalysis.computeResponseTime(taskList[2]) == 17);
+    REQUIRE(pipAnalysis.runRTATest() == true);
+
+    Inheritance icpp(taskList, numOfResources, CHOICE_ICPP);
+    BlockingAnalysis icppAnalysis(icpp);
+    vector<int> icppBlocking = {4, 4, 4, 3, 0};
+    for (size_t i = 0; i < taskList.size(); ++i)
+        REQUIRE(icppAnalysis.computeBlockingTime(taskList[i]) == icppBlocking[i]);
+    REQUIRE(icppAnalysis.computeResponseTime(taskList[2]) == 14);
+
+    // a 5 unit critical section in the lowest priority job breaks the PIP bound for task 3
+    taskList[4].resourceSequence[0].duration = 5;
+    Inheritance longSection(taskList, numOfResources, CHOICE_PIP);
+    REQUIRE(BlockingAnalysis(longSection).runRTATest() == false);
 }
 
 TEST_CASE("Scheduler Tests Arb Deadline")
@@ -168,7 +392,828 @@ TEST_CASE("Scheduler Tests Arb Deadline")
 
     Scheduler scheduler(tasks, CHOICE_ARB_DEADLINE);
 
-    scheduler.runOPA();
+    // with T2 above it, the first job of T1 responds in 104 but the second, still in the
+    // same busy period, only finishes at 208, 108 after its release
+    REQUIRE(scheduler.computeResponseTime(tasks[0], {tasks[1]}) == 108);
+    // T2 below T1 would respond in 156 > 154, so OPA must put T1 at the bottom
+    REQUIRE(scheduler.computeResponseTime(tasks[1], {tasks[0]}) == 156);
+    // these sum to exactly 1, though adding them up in double in this order gives 1.0000000000000002
+    vector<Task> full = {{1, 1, 20, 20}, {2, 1, 2, 2}, {3, 1, 12, 12}, {4, 1, 3, 3}, {5, 1, 30, 30}};
+    REQUIRE(scheduler.computeResponseTime(full[0], {full[1], full[2], full[3], full[4]}) == 28);
+    full[0].WCET = 2;
+    REQUIRE(scheduler.computeResponseTime(full[0], {full[1], full[2], full[3], full[4]}) == LLONG_MAX);
+    REQUIRE(scheduler.runOPA());
+    REQUIRE(scheduler.tasks_[0].priority == 1);
+    REQUIRE(scheduler.tasks_[1].priority == 2);
+    scheduler.generateTimeline();
+    REQUIRE(scheduler.renderTimeline("arb_deadline") == 1);
+
+    // C / D is only 0.12 here, but C / T is 1.2, so the utilization bound must not pass the set
+    vector<Task> overloaded = {{1, 6, 10, 100}, {2, 6, 10, 100}};
+    Scheduler rm(overloaded, CHOICE_RM);
+    REQUIRE(rm.runRMDMTest(rm.tasks_) == false);
+}
+
+TEST_CASE("Priority Orders")
+{
+    // id WCET period deadline
+    vector<Task> tasks = {
+        {1, 4, 20, 10},
+        {2, 1, 10, 10},
+        {3, 2, 20, 6},
+        {4, 3, 10, 9}};
+    Scheduler scheduler(tasks, CHOICE_RM);
+    auto priorities = [&]() {
+        vector<int> result;
+        for (const auto &task : scheduler.tasks_)
+            result.push_back(task.priority);
+        return result;
+    };
+
+    // equal periods fall back to the shorter deadline
+    scheduler.setPriority();
+    REQUIRE(priorities() == vector<int>({1, 3, 2, 4}));
+    // reassigning starts over rather than keeping earlier priorities
+    scheduler.setPriority(ORDER_DEADLINE_MONOTONIC);
+    REQUIRE(priorities() == vector<int>({1, 2, 4, 3}));
+    // D - C: 6, 9, 4, 6, the tie going to the shorter deadline
+    scheduler.setPriority(ORDER_SLACK_MONOTONIC);
+    REQUIRE(priorities() == vector<int>({2, 1, 4, 3}));
+    // C/T: 0.2, 0.1, 0.1, 0.3
+    scheduler.setPriority(ORDER_UTILIZATION);
+    REQUIRE(priorities() == vector<int>({3, 2, 1, 4}));
+    scheduler.setPriority(ORDER_SHORTEST_WCET);
+    REQUIRE(priorities() == vector<int>({1, 4, 3, 2}));
+    REQUIRE_THROWS_AS(scheduler.setPriority(5), runtime_error);
+
+    // fully tied tasks are ordered by id whatever their position
+    vector<Task> tied = {
+        {3, 1, 8, 8},
+        {1, 1, 8, 8},
+        {2, 1, 8, 8}};
+    Scheduler ties(tied, CHOICE_DM);
+    ties.setPriority();
+    REQUIRE(ties.tasks_[0].priority == 1);
+    REQUIRE(ties.tasks_[1].priority == 3);
+    REQUIRE(ties.tasks_[2].priority == 2);
+
+    // large generated sets
+    vector<Task> many;
+    for (int id = 1; id <= 50000; ++id)
+        many.push_back({id, 1 + id % 7, 100 + (id * 7919) % 100000, 100 + (id * 7919) % 100000});
+    Scheduler large(many, CHOICE_RM);
+    large.setPriority();
+    int highest = max_element(large.tasks_.begin(), large.tasks_.end(), [](const Task &a, const Task &b) {
+                      return a.priority < b.priority;
+                  })->period;
+    REQUIRE(highest == min_element(many.begin(), many.end(), [](const Task &a, const Task &b) {
+                           return a.period < b.period;
+                       })->period);
+}
+
+TEST_CASE("Feasibility Interval")
+{
+    NullSink sink;
+    // the OPA order of the Arb Deadline set meets every deadline and the backlog is empty at H
+    vector<Task> tasks = {
+        {1, 52, 100, 110, 1},
+        {2, 52, 140, 154, 2}};
+    Scheduler opa(tasks, CHOICE_ARB_DEADLINE);
+    FeasibilityResult result = opa.simulateFeasibilityInterval(sink);
+    REQUIRE(result.steady);
+    REQUIRE(result.cycleStart == 0);
+    REQUIRE(result.cycleLength == 700);
+    REQUIRE(result.misses.empty());
+
+    // with T1 on top the first job of T2 finishes at 156
+    tasks[0].priority = 2;
+    tasks[1].priority = 1;
+    Scheduler swapped(tasks, CHOICE_ARB_DEADLINE);
+    result = swapped.simulateFeasibilityInterval(sink);
+    REQUIRE(result.misses.size() == 1);
+    REQUIRE(result.misses[0].taskId == 2);
+    REQUIRE(result.misses[0].deadline == 154);
+    REQUIRE(result.misses[0].completion == 156);
+
+    // overloaded, but aborting late jobs bounds the backlog: the state at 12 differs from the
+    // empty start and comes back at 24
+    vector<Task> full = {
+        {1, 3, 4, 5, 2},
+        {2, 3, 6, 8, 1}};
+    Scheduler carried(full, CHOICE_ARB_DEADLINE);
+    carried.setMissPolicy(MISS_ABORT);
+    result = carried.simulateFeasibilityInterval(sink);
+    REQUIRE(result.steady);
+    REQUIRE(result.cycleStart == 12);
+    REQUIRE(result.cycleLength == 12);
+    REQUIRE(result.simulated == 24);
+    REQUIRE(result.misses.size() == 3);
+
+    // while late jobs run on, an overloaded set never settles
+    vector<Task> overloaded = {
+        {1, 3, 4, 4, 2},
+        {2, 3, 6, 6, 1}};
+    Scheduler overload(overloaded, CHOICE_ARB_DEADLINE);
+    result = overload.simulateFeasibilityInterval(sink);
+    REQUIRE(!result.steady);
+    REQUIRE(!result.misses.empty());
+}
+
+TEST_CASE("Deadline Miss Policies")
+{
+    // the first job of T2 still needs a tick at its deadline 6
+    vector<Task> tasks = {
+        {1, 2, 4, 4, 2},
+        {2, 3, 6, 6, 1}};
+
+    Scheduler continued(tasks, CHOICE_ARB_DEADLINE);
+    REQUIRE(!continued.generateTimeline());
+    REQUIRE(formatTimeline(continued.timeline) == "|T1|T1|T2|T2|T1|T1|T2|T2|T1|T1|T2|T2|");
+    REQUIRE(continued.getDeadlineMisses().size() == 1);
+    REQUIRE(continued.getDeadlineMisses()[0].taskId == 2);
+    REQUIRE(continued.getDeadlineMisses()[0].deadline == 6);
+    REQUIRE(continued.getDeadlineMisses()[0].completion == 7);
+
+    Scheduler aborted(tasks, CHOICE_ARB_DEADLINE);
+    aborted.setMissPolicy(MISS_ABORT);
+    aborted.generateTimeline();
+    REQUIRE(formatTimeline(aborted.timeline) == "|T1|T1|T2|T2|T1|T1|T2|T2|T1|T1|T2|ID|");
+    REQUIRE(aborted.getDeadlineMisses()[0].completion == -1);
+
+    Scheduler skipped(tasks, CHOICE_ARB_DEADLINE);
+    skipped.setMissPolicy(MISS_SKIP_NEXT);
+    skipped.generateTimeline();
+    REQUIRE(formatTimeline(skipped.timeline) == "|T1|T1|T2|T2|T1|T1|T2|ID|T1|T1|ID|ID|");
+    REQUIRE(skipped.getDeadlineMisses().size() == 1);
+
+    // fast reject stops at the deadline of the first late job
+    Scheduler rejected(tasks, CHOICE_ARB_DEADLINE);
+    rejected.setMissPolicy(MISS_CONTINUE, true);
+    REQUIRE(!rejected.generateTimeline());
+    REQUIRE(formatTimeline(rejected.timeline) == "|T1|T1|T2|T2|T1|T1|");
+    REQUIRE(rejected.getDeadlineMisses()[0].completion == -1);
+
+    REQUIRE_THROWS_AS(rejected.setMissPolicy(3), runtime_error);
+
+    tasks[0].WCET = 1;
+    Scheduler feasible(tasks, CHOICE_ARB_DEADLINE);
+    feasible.setMissPolicy(MISS_ABORT, true);
+    REQUIRE(feasible.generateTimeline());
+    REQUIRE(feasible.getDeadlineMisses().empty());
+}
+
+TEST_CASE("Concurrent Schedulers")
+{
+    // equal deadlines: the tie-break depends on which task ran last in this simulation only
+    vector<Task> ties = {
+        {1, 1, 4, 4},
+        {2, 2, 4, 4}};
+    Scheduler alone(ties, CHOICE_EDF);
+    alone.generateTimeline();
+    string expected = formatTimeline(alone.timeline);
+    Scheduler other({{1, 1, 5, 5}, {2, 1, 5, 5}, {3, 2, 5, 5}}, CHOICE_LST);
+    other.generateTimeline();
+    Scheduler after(ties, CHOICE_EDF);
+    after.generateTimeline();
+    REQUIRE(formatTimeline(after.timeline) == expected);
+
+    const int choices[] = {CHOICE_RM, CHOICE_DM, CHOICE_EDF, CHOICE_LST, CHOICE_PIP, CHOICE_SRP};
+    auto simulate = [&](int k) -> string {
+        int choice = choices[k % 6];
+        if (choice == CHOICE_PIP || choice == CHOICE_SRP)
+        {
+            vector<Job> jobs = {
+                {1, 10, 4, 5, 23, 23, {{1, 3}}},
+                {2, 8, 3, 4, 23, 23, {{2, 2}}},
+                {3, 6, 3, 3, 23, 23, {{1, 2}}},
+                {4, 3, 7, 2, 23, 23, {{1, 4, {{2, 2}}}}},
+                {5, 0, 6, 1, 23, 23, {{2, 3}}}};
+            Inheritance inheritance(jobs, 2, choice, 23 * (1 + k % 3));
+            inheritance.simulateResource();
+            return formatTimeline(TimelineQuery(inheritance).getIntervals());
+        }
+        vector<Task> tasks = {
+            {1, 1 + k % 3, 6, 6},
+            {2, 2, 8, 7},
+            {3, 1 + k % 2, 12, 10}};
+        Scheduler scheduler(tasks, choice);
+        if (choice == CHOICE_RM || choice == CHOICE_DM)
+            scheduler.setPriority();
+        scheduler.generateTimeline();
+        return formatTimeline(scheduler.timeline);
+    };
+
+    const int count = 96;
+    vector<string> sequential;
+    for (int k = 0; k < count; ++k)
+        sequential.push_back(simulate(k));
+
+    // a small pool of workers taking the next set until none are left
+    vector<string> parallel(count);
+    atomic<int> next(0);
+    vector<thread> pool;
+    for (int w = 0; w < 4; ++w)
+        pool.emplace_back([&]() {
+            for (int k = next++; k < count; k = next++)
+                parallel[k] = simulate(k);
+        });
+    for (auto &worker : pool)
+        worker.join();
+    REQUIRE(parallel == sequential);
+}
+
+TEST_CASE("Parallel Simulation")
+{
+    // T1 T2 T2 ID T1 ID T2 T2 T1 ID ID ID: the backlog is empty at 3, 5, 8 and 9
+    vector<Task> tasks = {
+        {1, 1, 4, 4},
+        {2, 2, 6, 6}};
+    Scheduler small(tasks, CHOICE_RM);
+    small.setPriority();
+    REQUIRE(small.computeIdleInstants(12) == vector<long long>({3, 5, 8, 9}));
+
+    vector<Task> moderate = {
+        {1, 2, 9, 9},
+        {2, 3, 14, 12},
+        {3, 2, 22, 22},
+        {4, 4, 30, 25}};
+    for (int choice : {CHOICE_RM, CHOICE_EDF, CHOICE_LST})
+    {
+        Scheduler sequential(moderate, choice);
+        Scheduler parallel(moderate, choice);
+        if (choice == CHOICE_RM)
+        {
+            sequential.setPriority();
+            parallel.setPriority();
+        }
+        parallel.setThreadCount(4);
+        REQUIRE_THROWS_AS(parallel.setThreadCount(0), runtime_error);
+        // a horizon that does not end on a hyperperiod boundary
+        long long horizon = 3 * sequential.computeHyperperiod() + 17;
+        sequential.generateTimeline(horizon);
+        parallel.generateTimeline(horizon);
+        REQUIRE(parallel.timeline.size() == sequential.timeline.size());
+        REQUIRE(formatTimeline(parallel.timeline) == formatTimeline(sequential.timeline));
+    }
+
+    // late jobs are reported as if simulated in one piece
+    vector<Task> late = {
+        {1, 2, 4, 4, 2},
+        {2, 3, 12, 6, 1}};
+    Scheduler sequential(late, CHOICE_ARB_DEADLINE);
+    Scheduler parallel(late, CHOICE_ARB_DEADLINE);
+    parallel.setThreadCount(3);
+    sequential.generateTimeline(120);
+    REQUIRE(!parallel.generateTimeline(120));
+    REQUIRE(formatTimeline(parallel.timeline) == formatTimeline(sequential.timeline));
+    REQUIRE(parallel.getDeadlineMisses().size() == 10);
+    REQUIRE(parallel.getDeadlineMisses().size() == sequential.getDeadlineMisses().size());
+    REQUIRE(parallel.getDeadlineMisses().back().completion == sequential.getDeadlineMisses().back().completion);
+}
+
+TEST_CASE("LST Minimum Quantum")
+{
+    // equal jobs: plain LST hands the processor around as their laxities cross
+    vector<Task> tasks = {
+        {1, 3, 12, 12},
+        {2, 3, 12, 12},
+        {3, 3, 12, 12}};
+    Scheduler lst(tasks, CHOICE_LST);
+    lst.generateTimeline();
+    REQUIRE(formatTimeline(lst.timeline) == "|T1|T2|T3|T3|T1|T2|T2|T1|T3|ID|ID|ID|");
+    REQUIRE(lst.getPreemptionCount() == 4);
+    REQUIRE(TimelineQuery(lst).preemptionCount() == 4);
+
+    Scheduler quantum(tasks, CHOICE_LST);
+    quantum.setMinimumQuantum(2);
+    quantum.generateTimeline();
+    REQUIRE(formatTimeline(quantum.timeline) == "|T1|T1|T2|T2|T3|T3|T3|T1|T2|ID|ID|ID|");
+    REQUIRE(quantum.getPreemptionCount() == 2);
+    quantum.setMinimumQuantum(3);
+    quantum.generateTimeline();
+    REQUIRE(quantum.getPreemptionCount() == 0);
+    REQUIRE(quantum.getDeadlineMisses().empty());
+    REQUIRE_THROWS_AS(quantum.setMinimumQuantum(0), runtime_error);
+
+    Scheduler edf(tasks, CHOICE_EDF);
+    edf.generateTimeline();
+    REQUIRE(formatTimeline(edf.timeline) == formatTimeline(quantum.timeline));
+    REQUIRE(edf.getPreemptionCount() == 0);
+
+    // over a long horizon the count kept by the simulator agrees with the timeline
+    vector<Task> mixed = {
+        {1, 2, 9, 9},
+        {2, 3, 14, 12},
+        {3, 2, 22, 22},
+        {4, 4, 30, 25}};
+    Scheduler events(mixed, CHOICE_LST);
+    events.generateTimeline(5000);
+    TimelineQuery query(events);
+    REQUIRE(query.getHorizon() == 5000);
+    REQUIRE(events.getPreemptionCount() == query.preemptionCount());
+    REQUIRE(events.getDeadlineMisses().empty());
+}
+
+TEST_CASE("Response Statistics")
+{
+    // T1 T2 T2 T3 T1 T3 T2 T2 T1 T3 ID ID
+    vector<Task> tasks = {
+        {1, 1, 4, 4},
+        {2, 2, 6, 6},
+        {3, 3, 12, 12}};
+    Scheduler scheduler(tasks, CHOICE_RM);
+    scheduler.setPriority();
+    scheduler.generateTimeline();
+    const vector<ResponseStatistics> &stats = scheduler.getResponseStatistics();
+    REQUIRE(stats.size() == 3);
+    REQUIRE(stats[1].jobs == 2);
+    REQUIRE(stats[1].minimum == 2);
+    REQUIRE(stats[1].maximum == 3);
+    REQUIRE(stats[1].mean() == Approx(2.5));
+    // the second job of T2 is released at 6 but only starts at 7
+    REQUIRE(stats[1].startJitter() == 1);
+    REQUIRE(stats[2].maximum == 10);
+    // observed and analytic worst cases coincide for a synchronous release
+    for (size_t i = 0; i < tasks.size(); ++i)
+        REQUIRE(scheduler.computeResponseBound(scheduler.tasks_[i]) == stats[i].maximum);
+
+    ostringstream report;
+    scheduler.displayResponseStatistics(report);
+    REQUIRE(report.str().find("T3    1       10      10.00     10      10      0       10      1.00") != string::npos);
+
+    // percentiles to the resolution of the buckets
+    ResponseStatistics wide(10);
+    for (long long response = 1; response <= 200; ++response)
+        wide.add(response, 0);
+    REQUIRE(wide.percentile(0.5) == 109);
+    REQUIRE(wide.percentile(0.99) == 199);
+    REQUIRE(wide.percentile(1.0) == 200);
+    ResponseStatistics late(10);
+    late.add(5000, 3);
+    wide.merge(late);
+    REQUIRE(wide.jobs == 201);
+    REQUIRE(wide.maximum == 5000);
+    REQUIRE(wide.startJitter() == 3);
+    // everything past the last bucket lands in it
+    REQUIRE(wide.histogram[RESPONSE_BUCKETS - 1] == 1);
+    // and a rank there is bounded by the largest response, not the bucket's lower range
+    ResponseStatistics overflow(10);
+    overflow.add(5, 0);
+    overflow.add(700, 0);
+    overflow.add(800, 0);
+    REQUIRE(overflow.percentile(0.5) == 800);
+    REQUIRE(overflow.percentile(0.3) == 9);
+
+    // the pieces of a parallel simulation add up to the sequential statistics
+    vector<Task> moderate = {
+        {1, 2, 9, 9},
+        {2, 3, 14, 12},
+        {3, 2, 22, 22},
+        {4, 4, 30, 25}};
+    Scheduler sequential(moderate, CHOICE_EDF);
+    Scheduler parallel(moderate, CHOICE_EDF);
+    parallel.setThreadCount(3);
+    sequential.generateTimeline(20000);
+    parallel.generateTimeline(20000);
+    for (size_t i = 0; i < moderate.size(); ++i)
+    {
+        const ResponseStatistics &a = sequential.getResponseStatistics()[i];
+        const ResponseStatistics &b = parallel.getResponseStatistics()[i];
+        REQUIRE(a.jobs == b.jobs);
+        REQUIRE(a.total == b.total);
+        REQUIRE(a.maximum == b.maximum);
+        REQUIRE(a.histogram == b.histogram);
+        REQUIRE(a.percentile(0.99) <= moderate[i].deadline);
+    }
+    REQUIRE(sequential.computeResponseBound(moderate[0]) == -1);
+}
+
+TEST_CASE("Policy Comparison")
+{
+    vector<Task> tasks = {
+        {1, 2, 9, 9},
+        {2, 3, 14, 12},
+        {3, 2, 22, 22},
+        {4, 4, 30, 25}};
+    const vector<int> choices = {CHOICE_RM, CHOICE_DM, CHOICE_EDF, CHOICE_LST};
+    // past the first window of shared releases
+    const long long horizon = 70000;
+    PolicyComparison comparison(tasks, choices);
+    comparison.run(horizon, true);
+    const vector<PolicyReport> &reports = comparison.getReports();
+    REQUIRE(reports.size() == 4);
+
+    // each policy does what its own Scheduler does
+    for (size_t k = 0; k < choices.size(); ++k)
+    {
+        Scheduler scheduler(tasks, choices[k]);
+        if (choices[k] == CHOICE_RM || choices[k] == CHOICE_DM)
+            scheduler.setPriority();
+        scheduler.generateTimeline(horizon);
+        REQUIRE(reports[k].choice == choices[k]);
+        REQUIRE(reports[k].timeline.size() == scheduler.timeline.size());
+        REQUIRE(formatTimeline(reports[k].timeline) == formatTimeline(scheduler.timeline));
+        REQUIRE(reports[k].misses.size() == scheduler.getDeadlineMisses().size());
+        REQUIRE(reports[k].preemptions == scheduler.getPreemptionCount());
+        TimelineQuery query(scheduler);
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            vector<long long> responses = query.responseTimes(tasks[i].id);
+            REQUIRE(reports[k].responses[i].maximum == *max_element(responses.begin(), responses.end()));
+        }
+    }
+
+    PolicyComparison sequential(tasks, choices);
+    sequential.run(horizon);
+    REQUIRE(formatTimeline(sequential.getReports()[3].timeline) == formatTimeline(reports[3].timeline));
+
+    ostringstream report;
+    comparison.writeReport(report);
+    REQUIRE(report.str().find("Policy  Misses  Preemptions  Worst response T1 T2 T3 T4") == 0);
+    REQUIRE(report.str().find("\nLST ") != string::npos);
+
+    REQUIRE_THROWS_AS(PolicyComparison(tasks, {CHOICE_PIP}), runtime_error);
+    REQUIRE_THROWS_AS(PolicyComparison({{1, 1, 0, 4}}, {CHOICE_EDF}), runtime_error);
+    REQUIRE_THROWS_AS(PolicyComparison({{1, 0, 4, 4}}, {CHOICE_EDF}), runtime_error);
+}
+
+TEST_CASE("Instrumentation")
+{
+    resetInstrumentation();
+    vector<Task> tasks = {
+        {1, 1, 4, 4},
+        {2, 2, 6, 6},
+        {3, 3, 12, 12}};
+    Scheduler scheduler(tasks, CHOICE_RM);
+    // U = 0.83 is over the Liu and Layland bound, so every task goes through the fixed point
+    REQUIRE(scheduler.runRMDMTest(tasks));
+    scheduler.generateTimeline();
+    ostringstream json;
+    writeInstrumentation(json);
+#ifdef SCHEDULER_INSTRUMENTATION
+    REQUIRE(json.str().find("\"enabled\":true") != string::npos);
+    // six releases and six completions over the 12 ticks of the hyperperiod
+    REQUIRE(json.str().find("\"simulationTicks\":12,") != string::npos);
+    REQUIRE(json.str().find("\"readyQueueOps\":12,") != string::npos);
+    REQUIRE(json.str().find("\"rtaIterationsPerTask\":{\"1\":") != string::npos);
+    REQUIRE(json.str().find("\"simulate\":{\"calls\":1,") != string::npos);
+    REQUIRE(json.str().find("\"analyze\":{\"calls\":1,") != string::npos);
+#else
+    REQUIRE(json.str() == "{\"enabled\":false}\n");
+#endif
+}
+
+TEST_CASE("Timeline Sinks")
+{
+    vector<Task> tasks = {
+        {1, 1, 4, 4},
+        {2, 2, 6, 6}};
+    Scheduler scheduler(tasks, CHOICE_RM);
+    scheduler.setPriority();
+
+    // T1 T2 T2 ID T1 ID T2 T2 T1 ID ID ID
+    MemorySink memory;
+    scheduler.generateTimeline(memory);
+    const vector<TimelineInterval> &intervals = memory.getIntervals();
+    REQUIRE(intervals.size() == 8);
+    REQUIRE(intervals[1].taskId == 2);
+    REQUIRE(intervals[1].start == 1);
+    REQUIRE(intervals[1].length == 2);
+    REQUIRE(intervals.back().taskId == IDLE_TASK);
+    REQUIRE(intervals.back().length == 3);
+
+    NullSink null;
+    scheduler.generateTimeline(null, 1200);
+    REQUIRE(null.getTickCount() == 1200);
+    REQUIRE(null.getIntervalCount() == 100 * 8);
+
+    {
+        BinaryFileSink binary("sink.bin");
+        scheduler.generateTimeline(binary);
+        REQUIRE_THROWS_AS(binary.push({1, 0, 1}), runtime_error);
+    }
+    vector<TimelineInterval> readBack = readBinaryTimeline("sink.bin");
+    REQUIRE(readBack.size() == intervals.size());
+    REQUIRE(readBack[6].taskId == intervals[6].taskId);
+    REQUIRE(readBack[6].start == intervals[6].start);
+    REQUIRE(readBack[6].length == intervals[6].length);
+
+    {
+        CSVSink csv("sink.csv");
+        scheduler.generateTimeline(csv);
+        REQUIRE_THROWS_AS(csv.push({1, 0, 1}), runtime_error);
+    }
+    ifstream file("sink.csv");
+    string header, first, second;
+    getline(file, header);
+    getline(file, first);
+    getline(file, second);
+    REQUIRE(header == "task,start,length");
+    REQUIRE(first == "T1,0,1");
+    REQUIRE(second == "T2,1,2");
+}
+
+TEST_CASE("Schedule File")
+{
+    vector<Task> tasks = {
+        {1, 1, 4, 4},
+        {2, 2, 6, 6}};
+    Scheduler scheduler(tasks, CHOICE_RM);
+    scheduler.setPriority();
+
+    // 2400 hyperperiods of T1 T2 T2 ID T1 ID T2 T2 T1 ID ID ID, enough for several index blocks
+    writeScheduleFile(scheduler, "rm.sched", 12 * 2400);
+    ScheduleFile file("rm.sched");
+    REQUIRE(file.getHorizon() == 12 * 2400);
+    REQUIRE(file.getTaskCount() == 2);
+    REQUIRE(file.getIntervalCount() == 8 * 2400);
+    REQUIRE(file.taskAt(0) == 1);
+    REQUIRE(file.taskAt(12 * 1000 + 2) == 2);
+    REQUIRE(file.taskAt(12 * 2399 + 11) == IDLE_TASK);
+    REQUIRE(file.taskAt(12 * 2400) == IDLE_TASK);
+    vector<TimelineInterval> runs = file.intervalsOf(2);
+    REQUIRE(runs.size() == 2 * 2400);
+    REQUIRE(runs[3].start == 12 + 6);
+    REQUIRE(runs[3].length == 2);
+    REQUIRE_THROWS(file.intervalsOf(3));
+
+    int numOfResources = 2;
+    vector<Job> taskList = {
+       {1, 10, 4, 5, 23, 23, {{1, 3}}},
+       {2, 8,  3, 4, 23, 23, {{2, 2}}},
+       {3, 6,  3, 3, 23, 23, {{1, 2}}},
+       {4, 3,  7, 2, 23, 23, {{1, 4, {{2, 2}}}}},
+       {5, 0,  6, 1, 23, 23, {{2, 3}}}
+    };
+    Inheritance inheritance(taskList, numOfResources, CHOICE_PIP, 2 * 23);
+    inheritance.simulateResource();
+    writeScheduleFile(inheritance, "pip.sched");
+    ScheduleFile pip("pip.sched");
+    REQUIRE(pip.getHorizon() == 2 * 23);
+    for (const auto &entry : inheritance.getTimeline())
+        REQUIRE(pip.taskAt(entry.time) == entry.jobId);
+
+    ofstream("not_a_schedule.txt") << "task,start,length\n";
+    REQUIRE_THROWS(ScheduleFile("not_a_schedule.txt"));
+    REQUIRE_THROWS(ScheduleFile("missing.sched"));
+}
+
+TEST_CASE("Timeline Query")
+{
+    vector<Task> tasks = {
+        {1, 1, 4, 4},
+        {2, 2, 6, 6}};
+    Scheduler scheduler(tasks, CHOICE_RM);
+    scheduler.setPriority();
     scheduler.generateTimeline();
-    scheduler.displayTimeline();
+    REQUIRE(formatTimeline(scheduler.timeline) == "|T1|T2|T2|ID|T1|ID|T2|T2|T1|ID|ID|ID|");
+
+    TimelineQuery query(scheduler);
+    REQUIRE(query.getHorizon() == 12);
+    REQUIRE(query.taskAt(0) == 1);
+    REQUIRE(query.taskAt(7) == 2);
+    REQUIRE(query.taskAt(11) == IDLE_TASK);
+    REQUIRE(query.taskAt(12) == IDLE_TASK);
+    REQUIRE(query.intervalsOf(2).size() == 2);
+    REQUIRE(query.idleIntervals().size() == 3);
+    REQUIRE(query.responseTimes(1) == vector<long long>{1, 1, 1});
+    REQUIRE(query.responseTimes(2) == vector<long long>{3, 2});
+    REQUIRE(query.preemptionCount() == 0);
+    REQUIRE(query.contextSwitchCount() == 4);
+    REQUIRE_THROWS(query.intervalsOf(3));
+
+    // the first job of T2 is aborted at 6 after two of its three ticks; the next one, released
+    // at 6, completes at 11
+    vector<Task> late = {
+        {1, 2, 4, 4, 2},
+        {2, 3, 6, 6, 1}};
+    Scheduler aborted(late, CHOICE_ARB_DEADLINE);
+    aborted.setMissPolicy(MISS_ABORT);
+    aborted.generateTimeline();
+    REQUIRE(formatTimeline(aborted.timeline) == "|T1|T1|T2|T2|T1|T1|T2|T2|T1|T1|T2|ID|");
+    TimelineQuery abortedQuery(aborted);
+    REQUIRE(abortedQuery.responseTimes(2) == vector<long long>{5});
+    REQUIRE(abortedQuery.responseTimes(1) == vector<long long>{2, 2, 2});
+    REQUIRE(abortedQuery.preemptionCount(2) == 2);
+    REQUIRE(abortedQuery.preemptionCount() == aborted.getPreemptionCount());
+
+    // T3 runs to the end of its R1 section at 5 before T1 and T2 preempt it
+    int numOfResources = 2;
+    vector<Job> taskList = {
+       {1, 2, 2, 3, 20, 20, {{1, 1}}},
+       {2, 3, 4, 2, 20, 20, {}},
+       {3, 0, 6, 1, 20, 20, {{1, 5, {{2, 2}}}}}
+    };
+    Inheritance inheritance(taskList, numOfResources, CHOICE_PIP);
+    inheritance.simulateResource();
+    TimelineQuery pip(inheritance);
+    REQUIRE(pip.getHorizon() == 12);
+    REQUIRE(pip.responseTimes(3) == vector<long long>{12});
+    REQUIRE(pip.responseTimes(1) == vector<long long>{5});
+    REQUIRE(pip.preemptionCount(3) == 1);
+    REQUIRE(pip.contextSwitchCount() == 3);
+}
+
+TEST_CASE("Task Files")
+{
+    istringstream csv("id,wcet,period,deadline\n# comment\n1,21,80,80\n\n2,9,25,25\n");
+    vector<Task> tasks = readTasks(csv, TASK_FORMAT_CSV);
+    REQUIRE(tasks.size() == 2);
+    REQUIRE(tasks[1].id == 2);
+    REQUIRE(tasks[1].WCET == 9);
+    REQUIRE(tasks[1].deadline == 25);
+
+    istringstream jsonl("{\"id\":3,\"wcet\":4,\"period\":20,\"deadline\":18}\n");
+    tasks = readTasks(jsonl, TASK_FORMAT_JSONL);
+    REQUIRE(tasks.size() == 1);
+    REQUIRE(tasks[0].deadline == 18);
+
+    istringstream jobsCsv("4,3,7,2,23,23,1:4(2:2);3:1,16\n5,0,6,1,23,23,\n");
+    vector<Job> jobs = readJobs(jobsCsv, TASK_FORMAT_CSV);
+    REQUIRE(jobs.size() == 2);
+    REQUIRE(jobs[0].resourceSequence.size() == 2);
+    REQUIRE(jobs[0].resourceSequence[0].nested[0].id == 2);
+    REQUIRE(jobs[0].resourceSequence[1].duration == 1);
+    REQUIRE(jobs[0].stackSize == 16);
+    REQUIRE(jobs[1].resourceSequence.empty());
+    REQUIRE(countResources(jobs) == 3);
+
+    istringstream jobsJson("{\"id\":1,\"release\":10,\"wcet\":4,\"priority\":5,\"period\":23,\"deadline\":23,"
+                           "\"sections\":[{\"resource\":1,\"duration\":4,\"nested\":[{\"resource\":2,\"duration\":2}]}]}\n");
+    jobs = readJobs(jobsJson, TASK_FORMAT_JSONL);
+    REQUIRE(jobs[0].releaseTime == 10);
+    REQUIRE(jobs[0].resourceSequence[0].nested[0].duration == 2);
+
+    istringstream broken("1,21,80,80\n2,9,x,25\n");
+    REQUIRE_THROWS_WITH(readTasks(broken, TASK_FORMAT_CSV), Catch::Contains("line 2"));
+    istringstream unbalanced("4,3,7,2,23,23,1:4(2:2\n");
+    REQUIRE_THROWS(readJobs(unbalanced, TASK_FORMAT_CSV));
+}
+
+TEST_CASE("Command Line")
+{
+    auto run = [](vector<string> arguments, const string &tasks) {
+        ofstream("cli_tasks.csv") << tasks;
+        arguments.insert(arguments.begin(), "scheduler");
+        arguments.insert(arguments.end(), {"--tasks", "cli_tasks.csv", "--no-timeline"});
+        vector<char *> argv;
+        for (auto &argument : arguments)
+            argv.push_back(&argument[0]);
+        return runCommandLine(static_cast<int>(argv.size()), argv.data());
+    };
+    REQUIRE(run({"--algorithm", "rm"}, "1,1,4,4\n2,2,6,6\n") == 0);
+    REQUIRE(run({"--algorithm", "edf"}, "1,2,4,4\n2,4,6,6\n") == 1);
+    // nonsense timing is bad input, not a verdict
+    for (const char *algorithm : {"rm", "edf"})
+    {
+        REQUIRE(run({"--algorithm", algorithm}, "1,1,0,4\n") == 2);
+        REQUIRE(run({"--algorithm", algorithm}, "1,0,4,4\n") == 2);
+        REQUIRE(run({"--algorithm", algorithm}, "1,-1,4,4\n") == 2);
+        REQUIRE(run({"--algorithm", algorithm}, "1,1,4,0\n") == 2);
+        REQUIRE(run({"--algorithm", algorithm}, "1,1,4294967300,4\n") == 2);
+    }
+    REQUIRE(run({"--compare", "rm,edf"}, "1,1,0,4\n") == 2);
+    REQUIRE(run({"--algorithm", "pip"}, "1,0,2,1,0,10,\n") == 2);
+    // the deadline of a job is absolute, so it must come after the release
+    REQUIRE(run({"--algorithm", "pip"}, "1,10,2,1,20,10,\n") == 2);
+    REQUIRE(run({"--algorithm", "pip"}, "1,10,2,1,20,30,\n") == 0);
+    REQUIRE(run({"--algorithm", "pip", "--horizon", "4294967336"}, "1,0,2,1,20,20,\n") == 2);
+
+    istringstream wide("{\"id\":1,\"wcet\":4294967297,\"period\":20,\"deadline\":20}\n");
+    REQUIRE_THROWS_WITH(readTasks(wide, TASK_FORMAT_JSONL), Catch::Contains("out of range"));
+}
+
+TEST_CASE("Task Set Corpus")
+{
+    {
+        ofstream corpus("corpus.txt");
+        corpus << "# id,WCET,period,deadline\n";
+        for (int set = 0; set < 500; ++set)
+        {
+            for (int id = 1; id <= 1 + set % 4; ++id)
+                corpus << id << "," << id + set % 3 << "," << 10 * id << "," << 10 * id << "\r\n";
+            corpus << "\n";
+        }
+    }
+    TaskSetCorpus corpus("corpus.txt");
+    TaskSetBatch whole = corpus.parseTasks(corpus.split(1)[0]);
+    REQUIRE(whole.size() == 500);
+    REQUIRE(whole.tasks.size() == 125 * (1 + 2 + 3 + 4));
+    REQUIRE(whole.set(7).size() == 4);
+    REQUIRE(whole.set(7)[3].WCET == 5);
+
+    // chunks hold whole sets, so parsing them on separate threads gives the same sets
+    vector<CorpusChunk> chunks = corpus.split(4);
+    REQUIRE(chunks.size() == 4);
+    REQUIRE(chunks.front().begin == 0);
+    REQUIRE(chunks.back().end == corpus.size());
+    vector<TaskSetBatch> batches(chunks.size());
+    vector<thread> workers;
+    for (size_t i = 0; i < chunks.size(); ++i)
+        workers.emplace_back([&, i]() { batches[i] = corpus.parseTasks(chunks[i]); });
+    for (auto &worker : workers)
+        worker.join();
+    size_t set = 0;
+    bool sameSets = true;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        REQUIRE((i == 0 || chunks[i].begin == chunks[i - 1].end));
+        for (size_t k = 0; k < batches[i].size(); ++k, ++set)
+            sameSets = sameSets && batches[i].set(k).size() == whole.set(set).size();
+    }
+    REQUIRE(set == 500);
+    REQUIRE(sameSets);
+
+    const char jobs[] = "4,3,7,2,23,23,1:4(2:2);3:1,16\n5,0,6,1,23,23\n\n1,0,2,1,10,10,\n";
+    JobSetBatch jobBatch;
+    parseJobSets(jobs, jobs + sizeof(jobs) - 1, jobBatch);
+    REQUIRE(jobBatch.size() == 2);
+    REQUIRE(jobBatch.set(0)[0].resourceSequence[0].nested[0].id == 2);
+    REQUIRE(jobBatch.set(0)[0].stackSize == 16);
+    REQUIRE(jobBatch.set(1)[0].resourceSequence.empty());
+
+    const char broken[] = "1,2,10,10\n2,x,10,10\n";
+    TaskSetBatch brokenBatch;
+    REQUIRE_THROWS_WITH(parseTaskSets(broken, broken + sizeof(broken) - 1, brokenBatch), Catch::Contains("byte 12"));
+    const char idle[] = "1,2,10,10\n\n2,1,0,10\n";
+    REQUIRE_THROWS_WITH(parseTaskSets(idle, idle + sizeof(idle) - 1, brokenBatch), Catch::Contains("byte 11: period"));
+    const char late[] = "1,0,2,1,10,10\n2,5,2,1,10,5\n";
+    JobSetBatch lateBatch;
+    REQUIRE_THROWS_WITH(parseJobSets(late, late + sizeof(late) - 1, lateBatch), Catch::Contains("byte 14: deadline"));
+}
+
+TEST_CASE("Binary Corpus")
+{
+    auto makeSet = [](int k) {
+        vector<Task> tasks;
+        for (int id = 1; id <= 1 + k % 5; ++id)
+            tasks.push_back({id, id + k % 7, 10 * id + k, 10 * id + k - 1, 0});
+        return tasks;
+    };
+    for (bool compressed : {false, true})
+    {
+        string path = compressed ? "tasks_packed.corpus" : "tasks.corpus";
+        CorpusWriter writer(path, CORPUS_TASKS, compressed);
+        for (int k = 0; k < 1000; ++k)
+            writer.addTaskSet(makeSet(k));
+        writer.finish();
+
+        CorpusFile corpus(path);
+        REQUIRE(corpus.size() == 1000);
+        REQUIRE(corpus.isCompressed() == compressed);
+        vector<Task> tasks = corpus.taskSet(737);
+        REQUIRE(tasks.size() == makeSet(737).size());
+        REQUIRE(tasks[2].period == makeSet(737)[2].period);
+        REQUIRE(tasks[2].deadline == makeSet(737)[2].deadline);
+        REQUIRE_THROWS(corpus.taskSet(1000));
+        REQUIRE_THROWS(corpus.jobSet(0));
+        size_t count = 0;
+        if (!compressed)
+        {
+            const CorpusTaskRecord *records = corpus.taskRecords(4, count);
+            REQUIRE(count == 5);
+            REQUIRE(records[4].WCET == 9);
+        }
+        else
+            REQUIRE_THROWS(corpus.taskRecords(4, count));
+    }
+
+    vector<Job> jobs = {
+       {1, 10, 4, 5, 23, 23, {{1, 3}}},
+       {4, 3,  7, 2, 23, 23, {{1, 4, {{2, 2}}}, {3, 1}}},
+       {5, 0,  6, 1, 23, 23, {}}
+    };
+    jobs[1].stackSize = 12;
+    CorpusWriter writer("jobs.corpus", CORPUS_JOBS, true);
+    writer.addJobSet(jobs);
+    writer.addJobSet({});
+    writer.finish();
+    CorpusFile corpus("jobs.corpus");
+    REQUIRE(corpus.size() == 2);
+    vector<Job> readBack = corpus.jobSet(0);
+    REQUIRE(readBack.size() == 3);
+    REQUIRE(readBack[1].stackSize == 12);
+    REQUIRE(readBack[1].resourceSequence.size() == 2);
+    REQUIRE(readBack[1].resourceSequence[0].nested[0].id == 2);
+    REQUIRE(readBack[1].resourceSequence[1].duration == 1);
+    REQUIRE(readBack[2].resourceSequence.empty());
+    REQUIRE(corpus.jobSet(1).empty());
+
+    CorpusWriter checked("checked.corpus", CORPUS_TASKS);
+    REQUIRE_THROWS_WITH(checked.addTaskSet({{1, 2, 10, 10, 0}, {2, 1, 0, 10, 0}}), Catch::Contains("id 2: period"));
+    CorpusWriter checkedJobs("checked_jobs.corpus", CORPUS_JOBS);
+    REQUIRE_THROWS_WITH(checkedJobs.addJobSet({{1, 10, 4, 5, 23, 8, {}}}), Catch::Contains("id 1: deadline"));
+    checked.addTaskSet({{1, 2, 10, 10, 0}});
+    checked.finish();
+    {
+        // zero the period of the only task, as a corrupt or hand-built file would
+        fstream patch("checked.corpus", ios::in | ios::out | ios::binary);
+        patch.seekp(sizeof(CorpusFileHeader) + 8 + offsetof(CorpusTaskRecord, period));
+        int32_t zero = 0;
+        patch.write(reinterpret_cast<const char *>(&zero), sizeof(zero));
+    }
+    CorpusFile patched("checked.corpus");
+    size_t count = 0;
+    REQUIRE_THROWS_WITH(patched.taskSet(0), Catch::Contains("period must be positive"));
+    REQUIRE_THROWS_WITH(patched.taskRecords(0, count), Catch::Contains("period must be positive"));
 }
@@ -0,0 +1,205 @@
+#include "timeline_query.hpp"
+
+// Jobs come from the simulator's records, since under MISS_ABORT and MISS_SKIP_NEXT they no
+// longer follow from the periods and the time each task has run
+TimelineQuery::TimelineQuery(const Scheduler &scheduler)
+{
+    for (const auto &task : scheduler.tasks_)
+        tasks.push_back({task.id, 0, task.period, task.WCET, true});
+    for (const auto &interval : scheduler.timeline)
+        add(interval.taskId, interval.start, interval.length);
+    index();
+    for (const auto &job : scheduler.getJobs())
+    {
+        if (job.completion >= 0)
+        {
+            responsesOf[job.taskId].push_back(job.completion - job.release);
+            jobEndsOf[job.taskId].push_back(job.completion);
+        }
+        else if (job.aborted)
+            jobEndsOf[job.taskId].push_back(job.deadline);
+    }
+    for (auto &ends : jobEndsOf)
+        sort(ends.second.begin(), ends.second.end());
+}
+
+TimelineQuery::TimelineQuery(const Inheritance &inheritance)
+{
+    bool periodic = inheritance.getHorizon() > 0;
+    for (const auto &job : inheritance.getJobTemplates())
+        tasks.push_back({job.id, job.releaseTime, job.period, job.WCET, periodic});
+    for (const auto &entry : inheritance.getTimeline())
+        add(entry.jobId, entry.time, 1);
+    if (periodic)
+        add(IDLE_TASK, horizon, inheritance.getHorizon() - horizon);
+    index();
+    for (const auto &task : tasks)
+    {
+        vector<long long> completions = completionTimes(task);
+        for (size_t k = 0; k < completions.size() && (task.periodic || k == 0); ++k)
+            responsesOf[task.id].push_back(completions[k] - (task.offset + static_cast<long long>(k) * task.period));
+        jobEndsOf[task.id] = completions;
+    }
+}
+
+// Appends a run, filling any gap before it with idle time and merging it into the last run
+// when the same task continues
+void TimelineQuery::add(int taskId, long long start, long long length)
+{
+    if (start > horizon)
+        add(IDLE_TASK, horizon, start - horizon);
+    if (length <= 0)
+        return;
+    if (!intervals.empty() && intervals.back().taskId == taskId)
+        intervals.back().length += length;
+    else
+        intervals.push_back({taskId, start, length});
+    horizon = start + length;
+}
+
+void TimelineQuery::index()
+{
+    starts.reserve(intervals.size());
+    for (size_t i = 0; i < intervals.size(); ++i)
+    {
+        starts.push_back(intervals[i].start);
+        if (intervals[i].taskId != IDLE_TASK)
+            runsOf[intervals[i].taskId].push_back(i);
+    }
+}
+
+const TimelineQuery::TaskModel &TimelineQuery::modelOf(int taskId) const
+{
+    for (const auto &task : tasks)
+    {
+        if (task.id == taskId)
+            return task;
+    }
+    throw runtime_error("Invalid Task ID");
+}
+
+long long TimelineQuery::getHorizon() const
+{
+    return horizon;
+}
+
+const vector<TimelineInterval> &TimelineQuery::getIntervals() const
+{
+    return intervals;
+}
+
+int TimelineQuery::taskAt(long long time) const
+{
+    if (time < 0 || time >= horizon)
+        return IDLE_TASK;
+    size_t i = upper_bound(starts.begin(), starts.end(), time) - starts.begin() - 1;
+    return intervals[i].taskId;
+}
+
+vector<TimelineInterval> TimelineQuery::intervalsOf(int taskId) const
+{
+    modelOf(taskId);
+    vector<TimelineInterval> result;
+    auto it = runsOf.find(taskId);
+    if (it == runsOf.end())
+        return result;
+    for (size_t i : it->second)
+        result.push_back(intervals[i]);
+    return result;
+}
+
+vector<TimelineInterval> TimelineQuery::idleIntervals() const
+{
+    vector<TimelineInterval> result;
+    for (const auto &interval : intervals)
+    {
+        if (interval.taskId == IDLE_TASK)
+            result.push_back(interval);
+    }
+    return result;
+}
+
+// Jobs of a task run in release order, so job k completes once the task has executed
+// (k + 1) * WCET units in total
+vector<long long> TimelineQuery::completionTimes(const TaskModel &task) const
+{
+    vector<long long> completions;
+    auto it = runsOf.find(task.id);
+    if (it == runsOf.end() || task.WCET <= 0)
+        return completions;
+    long long executed = 0;
+    for (size_t i : it->second)
+    {
+        const TimelineInterval &run = intervals[i];
+        long long needed = (static_cast<long long>(completions.size()) + 1) * task.WCET;
+        while (executed + run.length >= needed)
+        {
+            completions.push_back(run.start + needed - executed);
+            needed += task.WCET;
+        }
+        executed += run.length;
+    }
+    return completions;
+}
+
+vector<long long> TimelineQuery::responseTimes(int taskId) const
+{
+    modelOf(taskId);
+    auto it = responsesOf.find(taskId);
+    return it == responsesOf.end() ? vector<long long>() : it->second;
+}
+
+int TimelineQuery::preemptionCount(int taskId) const
+{
+    modelOf(taskId);
+    auto it = runsOf.find(taskId);
+    if (it == runsOf.end())
+        return 0;
+    auto ends = jobEndsOf.find(taskId);
+    const vector<long long> none;
+    const vector<long long> &jobEnds = ends == jobEndsOf.end() ? none : ends->second;
+    // a run that ends without a job completing or being aborted at its end was cut short
+    int preemptions = 0;
+    for (size_t i : it->second)
+    {
+        long long runEnd = intervals[i].start + intervals[i].length;
+        if (runEnd < horizon && !binary_search(jobEnds.begin(), jobEnds.end(), runEnd))
+            preemptions++;
+    }
+    return preemptions;
+}
+
+int TimelineQuery::preemptionCount() const
+{
+    int preemptions = 0;
+    for (const auto &task : tasks)
+        preemptions += preemptionCount(task.id);
+    return preemptions;
+}
+
+int TimelineQuery::contextSwitchCount() const
+{
+    int switches = 0;
+    int last = IDLE_TASK;
+    for (const auto &interval : intervals)
+    {
+        if (interval.taskId == IDLE_TASK)
+            continue;
+        if (last != IDLE_TASK && interval.taskId != last)
+            switches++;
+        last = interval.taskId;
+    }
+    return switches;
+}
+
+string formatTimeline(const vector<TimelineInterval> &timeline)
+{
+    string text;
+    for (const auto &interval : timeline)
+    {
+        string entry = interval.taskId == IDLE_TASK ? "|ID" : "|T" + to_string(interval.taskId);
+        for (long long i = 0; i < interval.length; ++i)
+            text += entry;
+    }
+    return text + "|";
+}
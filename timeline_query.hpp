@@ -0,0 +1,62 @@
+// Typed queries over simulation output, for consumers that should not care how the
+// simulator recorded it. The timeline is kept as sorted, coalesced runs with a per-task
+// index of positions, so point lookups are binary searches and per-task queries only
+// visit that task's runs.
+#ifndef TIMELINE_QUERY_HPP
+#define TIMELINE_QUERY_HPP
+#include "scheduler.hpp"
+
+class TimelineQuery
+{
+public:
+    TimelineQuery(const Scheduler &scheduler);
+    TimelineQuery(const Inheritance &inheritance);
+
+    long long getHorizon() const;
+    // Every run in time order, idle ones included
+    const vector<TimelineInterval> &getIntervals() const;
+    // Id of the task running at time, IDLE_TASK when idle or outside the timeline
+    int taskAt(long long time) const;
+    // Runs of the task in time order
+    vector<TimelineInterval> intervalsOf(int taskId) const;
+    vector<TimelineInterval> idleIntervals() const;
+    // Completion minus release of every job of the task that completed within the timeline,
+    // in release order
+    vector<long long> responseTimes(int taskId) const;
+    // Times a job of the task stopped running before it had completed
+    int preemptionCount(int taskId) const;
+    int preemptionCount() const;
+    // Dispatches of a task other than the one that ran last, idle time in between ignored
+    int contextSwitchCount() const;
+
+private:
+    // Releases and execution demand of a task's jobs, for Inheritance, which does not record them
+    struct TaskModel
+    {
+        int id;
+        long long offset; // release of the first job
+        long long period;
+        long long WCET;
+        bool periodic;    // false when only the first job is released
+    };
+
+    void add(int taskId, long long start, long long length);
+    void index();
+    const TaskModel &modelOf(int taskId) const;
+    // Time at which every job the task runs in completes, in release order, assuming each
+    // job runs to completion
+    vector<long long> completionTimes(const TaskModel &task) const;
+
+    vector<TimelineInterval> intervals; // coalesced runs, idle included, sorted by start
+    vector<long long> starts;           // intervals[i].start, kept apart for the binary search
+    map<int, vector<size_t>> runsOf;    // task id -> positions of its runs in intervals
+    map<int, vector<long long>> responsesOf; // task id -> response of each completed job
+    map<int, vector<long long>> jobEndsOf;   // task id -> sorted times a job completed or was aborted
+    vector<TaskModel> tasks;
+    long long horizon = 0;
+};
+
+// "|T1|T1|ID|..." with one entry per tick, as the simulator used to print it
+string formatTimeline(const vector<TimelineInterval> &timeline);
+
+#endif // TIMELINE_QUERY_HPP
@@ -0,0 +1,169 @@
+#include "timeline_sink.hpp"
+#include <charconv>
+#include <cstring>
+
+static const size_t sinkBufferSize = 1 << 16;
+
+void MemorySink::push(const TimelineInterval &interval)
+{
+    intervals.push_back(interval);
+}
+
+const vector<TimelineInterval> &MemorySink::getIntervals() const
+{
+    return intervals;
+}
+
+void NullSink::push(const TimelineInterval &interval)
+{
+    intervalCount++;
+    tickCount += interval.length;
+}
+
+long long NullSink::getIntervalCount() const
+{
+    return intervalCount;
+}
+
+long long NullSink::getTickCount() const
+{
+    return tickCount;
+}
+
+static FILE *openSinkFile(const string &path, const char *mode)
+{
+    FILE *file = fopen(path.c_str(), mode);
+    if (!file)
+        throw runtime_error("Cannot open " + path);
+    return file;
+}
+
+static void flushBuffer(FILE *file, const vector<char> &buffer, size_t &used)
+{
+    if (used > 0 && fwrite(buffer.data(), 1, used, file) != used)
+        throw runtime_error("Failed to write timeline");
+    used = 0;
+}
+
+static void putLittleEndian(char *out, unsigned long long value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        out[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+static unsigned long long getLittleEndian(const unsigned char *in, int bytes)
+{
+    unsigned long long value = 0;
+    for (int i = 0; i < bytes; ++i)
+        value |= static_cast<unsigned long long>(in[i]) << (8 * i);
+    return value;
+}
+
+BinaryFileSink::BinaryFileSink(const string &path)
+    : file(openSinkFile(path, "wb")), buffer(sinkBufferSize / recordSize * recordSize)
+{
+}
+
+// finish() reports write errors; a sink destroyed without it writes what it can
+BinaryFileSink::~BinaryFileSink()
+{
+    if (file)
+    {
+        fwrite(buffer.data(), 1, used, file);
+        fclose(file);
+    }
+}
+
+void BinaryFileSink::push(const TimelineInterval &interval)
+{
+    if (!file)
+        throw runtime_error("Timeline pushed after the sink was finished");
+    if (used == buffer.size())
+        flushBuffer(file, buffer, used);
+    char *record = buffer.data() + used;
+    putLittleEndian(record, interval.start, 8);
+    putLittleEndian(record + 8, interval.length, 8);
+    putLittleEndian(record + 16, static_cast<unsigned int>(interval.taskId), 4);
+    used += recordSize;
+}
+
+void BinaryFileSink::finish()
+{
+    if (!file)
+        return;
+    flushBuffer(file, buffer, used);
+    fclose(file);
+    file = nullptr;
+}
+
+vector<TimelineInterval> readBinaryTimeline(const string &path)
+{
+    FILE *file = openSinkFile(path, "rb");
+    vector<TimelineInterval> intervals;
+    unsigned char record[BinaryFileSink::recordSize];
+    while (fread(record, 1, sizeof(record), file) == sizeof(record))
+    {
+        intervals.push_back({static_cast<int>(getLittleEndian(record + 16, 4)),
+                             static_cast<long long>(getLittleEndian(record, 8)),
+                             static_cast<long long>(getLittleEndian(record + 8, 8))});
+    }
+    fclose(file);
+    return intervals;
+}
+
+CSVSink::CSVSink(const string &path) : file(openSinkFile(path, "w")), buffer(sinkBufferSize)
+{
+    static const char header[] = "task,start,length\n";
+    append(header, sizeof(header) - 1);
+}
+
+CSVSink::~CSVSink()
+{
+    if (file)
+    {
+        fwrite(buffer.data(), 1, used, file);
+        fclose(file);
+    }
+}
+
+void CSVSink::append(const char *text, size_t length)
+{
+    if (used + length > buffer.size())
+        flushBuffer(file, buffer, used);
+    memcpy(buffer.data() + used, text, length);
+    used += length;
+}
+
+void CSVSink::appendNumber(long long value)
+{
+    char digits[24];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    append(digits, result.ptr - digits);
+}
+
+void CSVSink::push(const TimelineInterval &interval)
+{
+    if (!file)
+        throw runtime_error("Timeline pushed after the sink was finished");
+    if (interval.taskId == IDLE_TASK)
+        append("ID", 2);
+    else
+    {
+        append("T", 1);
+        appendNumber(interval.taskId);
+    }
+    append(",", 1);
+    appendNumber(interval.start);
+    append(",", 1);
+    appendNumber(interval.length);
+    append("\n", 1);
+}
+
+void CSVSink::finish()
+{
+    if (!file)
+        return;
+    flushBuffer(file, buffer, used);
+    fclose(file);
+    file = nullptr;
+}
@@ -0,0 +1,86 @@
+// Destinations for simulated timelines. The simulator pushes one interval per run of a task,
+// so a sink that does not keep them (file writers, the null sink) simulates in constant memory.
+#ifndef TIMELINE_SINK_HPP
+#define TIMELINE_SINK_HPP
+#include "scheduler.hpp"
+#include <cstdio>
+
+class TimelineSink
+{
+public:
+    virtual ~TimelineSink() = default;
+    virtual void push(const TimelineInterval &interval) = 0;
+    // called once after the last interval
+    virtual void finish() {}
+    // Job events, reported as the simulation reaches them and ignored unless overridden: every
+    // release, and every deadline once it is known to be met (at the completion) or missed
+    virtual void release(int taskId, long long time) {}
+    virtual void deadline(int taskId, long long time, bool met) {}
+};
+
+// Keeps every interval in memory
+class MemorySink : public TimelineSink
+{
+public:
+    void push(const TimelineInterval &interval) override;
+    const vector<TimelineInterval> &getIntervals() const;
+
+private:
+    vector<TimelineInterval> intervals;
+};
+
+// Drops the intervals, only counting them; useful to time the simulator on its own
+class NullSink : public TimelineSink
+{
+public:
+    void push(const TimelineInterval &interval) override;
+    long long getIntervalCount() const;
+    long long getTickCount() const;
+
+private:
+    long long intervalCount = 0;
+    long long tickCount = 0;
+};
+
+// Writes fixed 20 byte little-endian records (start, length as int64, task id as int32)
+// through a buffer of its own, flushed when full and on finish. Both file sinks throw
+// runtime_error on a push after finish, which has closed the file.
+class BinaryFileSink : public TimelineSink
+{
+public:
+    explicit BinaryFileSink(const string &path);
+    ~BinaryFileSink();
+    void push(const TimelineInterval &interval) override;
+    void finish() override;
+
+    static const size_t recordSize = 20;
+
+private:
+    FILE *file;
+    vector<char> buffer;
+    size_t used = 0;
+};
+
+// Reads back a file written by BinaryFileSink
+vector<TimelineInterval> readBinaryTimeline(const string &path);
+
+// Writes "task,start,length" rows, the task column being "ID" for idle intervals.
+// Numbers are formatted with to_chars into a buffer instead of going through iostream.
+class CSVSink : public TimelineSink
+{
+public:
+    explicit CSVSink(const string &path);
+    ~CSVSink();
+    void push(const TimelineInterval &interval) override;
+    void finish() override;
+
+private:
+    void append(const char *text, size_t length);
+    void appendNumber(long long value);
+
+    FILE *file;
+    vector<char> buffer;
+    size_t used = 0;
+};
+
+#endif // TIMELINE_SINK_HPP
@@ -0,0 +1,235 @@
+#include "trace.hpp"
+
+TraceWriter::TraceWriter(ostream &out) : out(out), first(true), finished(false)
+{
+    out << "{\"traceEvents\":[\n";
+}
+
+TraceWriter::~TraceWriter()
+{
+    finish();
+}
+
+void TraceWriter::finish()
+{
+    if (finished)
+        return;
+    finished = true;
+    out << "\n]}\n";
+    out.flush();
+}
+
+// Writes the fields every event shares and leaves the object open for the rest
+void TraceWriter::beginEvent(const string &name, const char *phase, long long time)
+{
+    if (!first)
+        out << ",\n";
+    first = false;
+    out << "{\"name\":\"";
+    for (char c : name)
+    {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << "\",\"ph\":\"" << phase << "\",\"pid\":1,\"ts\":" << time;
+}
+
+void TraceWriter::threadName(int track, const string &name)
+{
+    beginEvent("thread_name", "M", 0);
+    out << ",\"tid\":" << track << ",\"args\":{\"name\":\"" << name << "\"}}";
+    // keep the tracks in id order instead of first-seen order
+    beginEvent("thread_sort_index", "M", 0);
+    out << ",\"tid\":" << track << ",\"args\":{\"sort_index\":" << track << "}}";
+}
+
+void TraceWriter::slice(const string &name, const string &category, int track, long long start, long long duration)
+{
+    beginEvent(name, "X", start);
+    out << ",\"cat\":\"" << category << "\",\"tid\":" << track << ",\"dur\":" << duration << "}";
+}
+
+void TraceWriter::instant(const string &name, const string &category, int track, long long time)
+{
+    beginEvent(name, "i", time);
+    out << ",\"cat\":\"" << category << "\",\"tid\":" << track << ",\"s\":\"t\"}";
+}
+
+void TraceWriter::counter(const string &name, long long time, int value)
+{
+    beginEvent(name, "C", time);
+    out << ",\"args\":{\"value\":" << value << "}}";
+}
+
+int cpuTrack()
+{
+    return 1;
+}
+
+int taskTrack(int taskId)
+{
+    return 100 + taskId;
+}
+
+int resourceTrack(int resourceId)
+{
+    return 10000 + resourceId;
+}
+
+// Coalesces consecutive ticks of one task into a single slice on the CPU track
+class RunTracker
+{
+public:
+    explicit RunTracker(TraceWriter &trace) : trace(trace) {}
+
+    void tick(int taskId, long long time)
+    {
+        if (taskId == current)
+            return;
+        close(time);
+        current = taskId;
+        start = time;
+    }
+
+    void close(long long time)
+    {
+        if (current != IDLE_TASK)
+            trace.slice("T" + to_string(current), "task", cpuTrack(), start, time - start);
+        current = IDLE_TASK;
+    }
+
+private:
+    TraceWriter &trace;
+    int current = IDLE_TASK;
+    long long start = 0;
+};
+
+TraceSink::TraceSink(ostream &out, const vector<Task> &tasks) : trace(out)
+{
+    trace.threadName(cpuTrack(), "CPU");
+    for (const auto &task : tasks)
+        trace.threadName(taskTrack(task.id), "T" + to_string(task.id));
+}
+
+bool TraceSink::Instant::operator>(const Instant &other) const
+{
+    return time != other.time ? time > other.time : order > other.order;
+}
+
+void TraceSink::writeInstants(long long until)
+{
+    for (; !instants.empty() && instants.top().time <= until; instants.pop())
+        trace.instant(instants.top().name, "job", taskTrack(instants.top().taskId), instants.top().time);
+}
+
+// each instant goes ahead of the run that starts with it
+void TraceSink::push(const TimelineInterval &interval)
+{
+    writeInstants(interval.start);
+    if (interval.taskId != IDLE_TASK)
+        trace.slice("T" + to_string(interval.taskId), "task", cpuTrack(), interval.start, interval.length);
+    end = max(end, interval.start + interval.length);
+}
+
+void TraceSink::release(int taskId, long long time)
+{
+    instants.push({time, arrivals++, "release", taskId});
+}
+
+void TraceSink::deadline(int taskId, long long time, bool met)
+{
+    instants.push({time, arrivals++, met ? "deadline" : "deadline miss", taskId});
+}
+
+// a met deadline past the end of the simulation is left out, like the runs beyond it
+void TraceSink::finish()
+{
+    writeInstants(end);
+    trace.finish();
+}
+
+// Releases and deadlines come from the simulator itself, since with MISS_ABORT, MISS_SKIP_NEXT
+// or a stop at the first miss they no longer follow from the periods and the time each task has run
+void exportTrace(Scheduler &scheduler, ostream &out, long long horizon)
+{
+    TraceSink sink(out, scheduler.tasks_);
+    scheduler.generateTimeline(sink, horizon);
+}
+
+void exportTrace(const Inheritance &inheritance, ostream &out)
+{
+    TraceWriter trace(out);
+    const vector<Job> &templates = inheritance.getJobTemplates();
+    const vector<simulate> &timeline = inheritance.getTimeline();
+    const bool periodic = inheritance.getHorizon() > 0;
+
+    trace.threadName(cpuTrack(), "CPU");
+    map<int, size_t> indexById;
+    for (size_t i = 0; i < templates.size(); ++i)
+    {
+        trace.threadName(taskTrack(templates[i].id), "T" + to_string(templates[i].id));
+        indexById[templates[i].id] = i;
+    }
+    for (const auto &resource : inheritance.getResources())
+        trace.threadName(resourceTrack(resource.id), "R" + to_string(resource.id));
+
+    long long end = timeline.empty() ? 0 : timeline.back().time + 1;
+    if (periodic)
+        end = max<long long>(end, inheritance.getHorizon());
+
+    RunTracker run(trace);
+    vector<long long> executed(templates.size(), 0);
+    vector<int> lastPriority(templates.size(), -1);
+
+    size_t next = 0;
+    for (long long t = 0; t <= end; ++t)
+    {
+        // instance k is released at releaseTime + k * period and is due at deadline + k * period
+        for (size_t i = 0; i < templates.size(); ++i)
+        {
+            const Job &job = templates[i];
+            long long sinceRelease = t - job.releaseTime;
+            if (t < end && sinceRelease >= 0 && sinceRelease % job.period == 0 && (periodic || sinceRelease == 0))
+                trace.instant("release", "job", taskTrack(job.id), t);
+            long long sinceDeadline = t - job.deadline;
+            if (sinceDeadline >= 0 && sinceDeadline % job.period == 0 && (periodic || sinceDeadline == 0))
+            {
+                long long instance = sinceDeadline / job.period;
+                bool met = executed[i] >= (instance + 1) * job.WCET;
+                trace.instant(met ? "deadline" : "deadline miss", "job", taskTrack(job.id), t);
+            }
+        }
+        if (t == end)
+            break;
+
+        if (next == timeline.size() || timeline[next].time != t)
+        {
+            run.tick(IDLE_TASK, t);
+            continue;
+        }
+        const simulate &entry = timeline[next++];
+        int jobId = entry.jobId;
+        run.tick(jobId, t);
+        auto it = indexById.find(jobId);
+        if (it != indexById.end())
+        {
+            size_t i = it->second;
+            executed[i]++;
+            // only changes are written, so a priority inheritance boost shows up as a step
+            if (entry.priority != lastPriority[i])
+            {
+                trace.counter("T" + to_string(jobId) + " priority", t, entry.priority);
+                lastPriority[i] = entry.priority;
+            }
+        }
+    }
+    run.close(end);
+    // a lock spans any preemption of its holder; one still held runs to the end of the trace
+    for (const auto &hold : inheritance.getResourceHolds())
+    {
+        long long until = hold.end < 0 ? end : hold.end;
+        trace.slice("T" + to_string(hold.holder), "lock", resourceTrack(hold.resourceId), hold.start, until - hold.start);
+    }
+    trace.finish();
+}
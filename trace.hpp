@@ -0,0 +1,74 @@
+// Export of simulated schedules as Chrome trace-event JSON, which chrome://tracing and
+// the Perfetto UI both open. One time unit of the schedule is exported as one microsecond.
+#ifndef TRACE_HPP
+#define TRACE_HPP
+#include "scheduler.hpp"
+#include "timeline_sink.hpp"
+#include <ostream>
+
+// Streams trace events straight to the output, so a trace is never held in memory.
+// The JSON array is closed by finish() or, failing that, by the destructor.
+class TraceWriter
+{
+public:
+    explicit TraceWriter(ostream &out);
+    ~TraceWriter();
+
+    void threadName(int track, const string &name);
+    void slice(const string &name, const string &category, int track, long long start, long long duration);
+    void instant(const string &name, const string &category, int track, long long time);
+    void counter(const string &name, long long time, int value);
+    void finish();
+
+private:
+    void beginEvent(const string &name, const char *phase, long long time);
+
+    ostream &out;
+    bool first;
+    bool finished;
+};
+
+// Tracks of the exported trace: the processor, one per task for releases, deadlines and
+// misses, and one per resource for the spans it is held
+int cpuTrack();
+int taskTrack(int taskId);
+int resourceTrack(int resourceId);
+
+// Writes a simulation as it runs: runs go out as slices when pushed, and each release and
+// deadline instant is held back only until the first run starting at or after it, so the
+// instants come out in time order with the runs. Only what is not yet due is kept in memory.
+class TraceSink : public TimelineSink
+{
+public:
+    TraceSink(ostream &out, const vector<Task> &tasks);
+
+    void push(const TimelineInterval &interval) override;
+    void release(int taskId, long long time) override;
+    void deadline(int taskId, long long time, bool met) override;
+    // writes the instants up to the end of the last run and closes the trace
+    void finish() override;
+
+private:
+    struct Instant
+    {
+        long long time;
+        long long order; // arrival, to keep instants at the same time in the order reported
+        const char *name;
+        int taskId;
+
+        bool operator>(const Instant &other) const;
+    };
+    void writeInstants(long long until);
+
+    TraceWriter trace;
+    priority_queue<Instant, vector<Instant>, greater<Instant>> instants;
+    long long arrivals = 0;
+    long long end = 0;
+};
+
+// Simulates horizon ticks of the scheduler (one hyperperiod when 0) straight into the trace;
+// like generateTimeline(sink), it keeps neither the timeline nor job records
+void exportTrace(Scheduler &scheduler, ostream &out, long long horizon = 0);
+void exportTrace(const Inheritance &inheritance, ostream &out);
+
+#endif // TRACE_HPP